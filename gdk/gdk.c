@@ -148,6 +148,7 @@ static const GdkDebugKey gdk_debug_keys[] = {
   { "no-vsync",        GDK_DEBUG_NO_VSYNC, "Repaint instantly (uses 100% CPU with animations)" },
   { "color-mgmt",      GDK_DEBUG_COLOR_MANAGEMENT, "Enable color management" },
   { "session-mgmt",    GDK_DEBUG_SESSION_MANAGEMENT, "Enable session management" },
+  { "frame-pacing",    GDK_DEBUG_FRAME_PACING, "Start frames just before they are needed" },
 };
 
 static const GdkDebugKey gdk_feature_keys[] = {
@@ -216,6 +216,21 @@ gdk_cairo_region_scale_grow (const cairo_region_t *region,
   return result;
 }
 
+static inline gint64
+gdk_cairo_region_get_pixels (const cairo_region_t *region)
+{
+  cairo_rectangle_int_t rect;
+  gint64 pixels = 0;
+
+  for (int i = 0; i < cairo_region_num_rectangles (region); i++)
+    {
+      cairo_region_get_rectangle (region, i, &rect);
+      pixels += (gint64) rect.width * rect.height;
+    }
+
+  return pixels;
+}
+
 static inline char *
 gdk_cairo_region_to_debug_string (const cairo_region_t *region)
 {
@@ -686,9 +686,23 @@ serialize_texture_in_thread (GTask        *task,
   value = gdk_content_serializer_get_value (serializer);
   texture = g_value_get_object (value);
 
+  /* png can be encoded straight into the output stream, which
+   * avoids holding the whole encoded image in memory
+   */
   if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/png") == 0)
-    bytes = gdk_save_png (texture, NULL);
-  else if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/tiff") == 0)
+    {
+      if (gdk_save_png_to_stream (texture,
+                                  NULL,
+                                  gdk_content_serializer_get_output_stream (serializer),
+                                  gdk_content_serializer_get_cancellable (serializer),
+                                  &error))
+        g_task_return_boolean (task, TRUE);
+      else
+        g_task_return_error (task, error);
+      return;
+    }
+
+  if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/tiff") == 0)
     bytes = gdk_save_tiff (texture);
   else if (strcmp (gdk_content_serializer_get_mime_type (serializer), "image/jpeg") == 0)
     bytes = gdk_save_jpeg (texture);
@@ -51,6 +51,7 @@ typedef enum {
   GDK_DEBUG_NO_VSYNC        = 1 << 23,
   GDK_DEBUG_COLOR_MANAGEMENT= 1 << 24,
   GDK_DEBUG_SESSION_MANAGEMENT= 1 << 25,
+  GDK_DEBUG_FRAME_PACING    = 1 << 26,
 } GdkDebugFlags;
 
 typedef enum {
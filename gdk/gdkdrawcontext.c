@@ -480,25 +480,6 @@ gdk_draw_context_begin_frame_full (GdkDrawContext        *context,
                                     });
 }
 
-#ifdef HAVE_SYSPROF
-static gint64
-region_get_pixels (cairo_region_t *region)
-{
-  int i, n;
-  cairo_rectangle_int_t rect;
-  gint64 pixels = 0;
-
-  n = cairo_region_num_rectangles (region);
-  for (i = 0; i < n; i++)
-    {
-      cairo_region_get_rectangle (region, i, &rect);
-      pixels += rect.width * rect.height;
-    }
-
-  return pixels;
-}
-#endif
-
 void
 gdk_draw_context_end_frame_full (GdkDrawContext *context,
                                  gpointer        context_data)
@@ -507,7 +488,7 @@ gdk_draw_context_end_frame_full (GdkDrawContext *context,
 
   GDK_DRAW_CONTEXT_GET_CLASS (context)->end_frame (context, context_data, priv->render_region);
 
-  gdk_profiler_set_int_counter (pixels_counter, region_get_pixels (priv->render_region));
+  gdk_profiler_set_int_counter (pixels_counter, gdk_cairo_region_get_pixels (priv->render_region));
 
   priv->color_state = NULL;
   g_clear_pointer (&priv->render_region, cairo_region_destroy);
@@ -32,6 +32,7 @@
 #include "gdkkeysprivate.h"
 #include "gdkkeysyms.h"
 #include "gdkprivate.h"
+#include "gdkprofilerprivate.h"
 
 #include <gobject/gvaluecollector.h>
 
@@ -596,6 +597,24 @@ _gdk_event_unqueue (GdkDisplay *display)
   return event;
 }
 
+static guint compressed_motions_counter;
+static guint compressed_scrolls_counter;
+static guint compressed_touches_counter;
+static gint64 compressed_motions;
+static gint64 compressed_scrolls;
+static gint64 compressed_touches;
+
+static void
+ensure_compression_counters (void)
+{
+  if (compressed_motions_counter != 0)
+    return;
+
+  compressed_motions_counter = gdk_profiler_define_int_counter ("compressed motions", "Motion events merged into later ones");
+  compressed_scrolls_counter = gdk_profiler_define_int_counter ("compressed scrolls", "Scroll events merged into later ones");
+  compressed_touches_counter = gdk_profiler_define_int_counter ("compressed touches", "Touch updates merged into later ones");
+}
+
 /*
  * If the last N events in the event queue are smooth scroll events
  * for the same surface, the same device and the same scroll unit,
@@ -684,6 +703,7 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
       gdk_event_unref (event);
       g_queue_delete_link (&display->queued_events, scrolls);
       scrolls = next;
+      compressed_scrolls++;
     }
 
   if (scrolls && history)
@@ -727,6 +747,9 @@ gdk_event_queue_handle_scroll_compression (GdkDisplay *display)
       g_queue_push_tail (&display->queued_events, event);
 
       gdk_event_unref (old_event);
+
+      ensure_compression_counters ();
+      gdk_profiler_set_int_counter (compressed_scrolls_counter, compressed_scrolls);
     }
 }
 
@@ -838,6 +861,125 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
       gdk_event_unref (pending_motions->data);
       g_queue_delete_link (&display->queued_events, pending_motions);
       pending_motions = next;
+      compressed_motions++;
+
+      if (pending_motions->next == NULL)
+        {
+          ensure_compression_counters ();
+          gdk_profiler_set_int_counter (compressed_motions_counter, compressed_motions);
+        }
+    }
+}
+
+static void
+gdk_touch_event_push_history (GdkEvent *event,
+                              GdkEvent *history_event)
+{
+  GdkTouchEvent *self = (GdkTouchEvent *) event;
+  GdkTimeCoord hist;
+  int i;
+
+  g_assert (GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE));
+  g_assert (GDK_IS_EVENT_TYPE (history_event, GDK_TOUCH_UPDATE));
+
+  if (G_UNLIKELY (!self->history))
+    self->history = g_array_new (FALSE, TRUE, sizeof (GdkTimeCoord));
+
+  if (((GdkTouchEvent *)history_event)->history)
+    {
+      GArray *history = ((GdkTouchEvent *)history_event)->history;
+      g_array_append_vals (self->history, history->data, history->len);
+    }
+
+  memset (&hist, 0, sizeof (GdkTimeCoord));
+  hist.time = gdk_event_get_time (history_event);
+
+  if (((GdkTouchEvent *)history_event)->axes)
+    {
+      for (i = GDK_AXIS_Y + 1; i < GDK_AXIS_LAST; i++)
+        {
+          if (gdk_event_get_axis (history_event, i, &hist.axes[i]))
+            hist.flags |= 1 << i;
+        }
+    }
+
+  hist.flags |= GDK_AXIS_FLAG_X | GDK_AXIS_FLAG_Y;
+  gdk_event_get_position (history_event, &hist.axes[GDK_AXIS_X], &hist.axes[GDK_AXIS_Y]);
+
+  g_array_append_val (self->history, hist);
+}
+
+/* If the last N events in the event queue are touch updates for
+ * the same surface and device, drop all but the last update of
+ * each touch sequence. The remaining updates get a history
+ * containing the dropped ones.
+ *
+ * Unlike motion events, updates for different sequences are
+ * usually interleaved, so we can't just look at the tail.
+ */
+void
+gdk_event_queue_handle_touch_compression (GdkDisplay *display)
+{
+  GList *l;
+  GList *updates = NULL;
+  GdkSurface *surface = NULL;
+  GdkDevice *device = NULL;
+  gboolean compressed = FALSE;
+
+  l = g_queue_peek_tail_link (&display->queued_events);
+
+  while (l)
+    {
+      GdkEvent *event = l->data;
+
+      if (event->flags & GDK_EVENT_PENDING)
+        break;
+
+      if (event->event_type != GDK_TOUCH_UPDATE)
+        break;
+
+      if (surface != NULL &&
+          surface != event->surface)
+        break;
+
+      if (device != NULL &&
+          device != event->device)
+        break;
+
+      surface = event->surface;
+      device = event->device;
+      updates = l;
+
+      l = l->prev;
+    }
+
+  while (updates && updates->next != NULL)
+    {
+      GdkEvent *event = updates->data;
+      GList *next = updates->next;
+
+      for (l = next; l; l = l->next)
+        {
+          if (gdk_event_get_event_sequence (l->data) == gdk_event_get_event_sequence (event))
+            break;
+        }
+
+      if (l != NULL)
+        {
+          gdk_touch_event_push_history (l->data, event);
+          gdk_event_unref (event);
+          g_queue_delete_link (&display->queued_events, updates);
+          compressed_touches++;
+          compressed = TRUE;
+        }
+
+      updates = next;
+    }
+
+  if (compressed)
+    {
+      ensure_compression_counters ();
+      gdk_profiler_set_int_counter (compressed_touches_counter, compressed_touches);
     }
 }
 
@@ -1999,6 +2141,8 @@ gdk_touch_event_finalize (GdkEvent *event)
   GdkTouchEvent *self = (GdkTouchEvent *) event;
 
   g_clear_pointer (&self->axes, g_free);
+  if (self->history)
+    g_array_free (self->history, TRUE);
 
   GDK_EVENT_SUPER (event)->finalize (event);
 }
@@ -3197,7 +3341,7 @@ gdk_motion_event_new (GdkSurface      *surface,
 
 /**
  * gdk_event_get_history:
- * @event: a motion or scroll event
+ * @event: a motion, scroll or touch update event
  * @out_n_coords: (out): Return location for the length of the returned array
  *
  * Retrieves the history of the device that @event is for, as a list of
@@ -3206,9 +3350,9 @@ gdk_motion_event_new (GdkSurface      *surface,
  * The history includes positions that are not delivered as separate events
  * to the application because they occurred in the same frame as @event.
  *
- * Note that only motion and scroll events record history, and motion
- * events do it only if one of the mouse buttons is down, or the device
- * has a tool.
+ * Note that only motion, scroll and touch update events record history,
+ * and motion events do it only if one of the mouse buttons is down, or
+ * the device has a tool.
  *
  * Returns: (transfer container) (array length=out_n_coords) (nullable): an
  *   array of time and coordinates
@@ -3221,7 +3365,8 @@ gdk_event_get_history (GdkEvent *event,
 
   g_return_val_if_fail (GDK_IS_EVENT (event), NULL);
   g_return_val_if_fail (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY) ||
-                        GDK_IS_EVENT_TYPE (event, GDK_SCROLL), NULL);
+                        GDK_IS_EVENT_TYPE (event, GDK_SCROLL) ||
+                        GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE), NULL);
   g_return_val_if_fail (out_n_coords != NULL, NULL);
 
   if (GDK_IS_EVENT_TYPE (event, GDK_MOTION_NOTIFY))
@@ -3229,6 +3374,11 @@ gdk_event_get_history (GdkEvent *event,
       GdkMotionEvent *self = (GdkMotionEvent *) event;
       history = self->history;
     }
+  else if (GDK_IS_EVENT_TYPE (event, GDK_TOUCH_UPDATE))
+    {
+      GdkTouchEvent *self = (GdkTouchEvent *) event;
+      history = self->history;
+    }
   else
     {
       GdkScrollEvent *self = (GdkScrollEvent *) event;
@@ -37,6 +37,12 @@
 
 #define FRAME_INTERVAL 16667 /* microseconds */
 
+/* When pacing frames, we aim to finish the frame this long
+ * before the next vblank, and we never delay a frame by more
+ * than half a refresh interval.
+ */
+#define FRAME_PACING_MARGIN 4000 /* microseconds */
+
 typedef enum {
   SMOOTH_PHASE_STATE_VALID = 0,    /* explicit, since we count on zero-init */
   SMOOTH_PHASE_STATE_AWAIT_FIRST,
@@ -58,6 +64,7 @@ struct _GdkFrameClockIdlePrivate
 
   gint64 sleep_serial;
   gint64 freeze_time; /* in microseconds */
+  gint64 frame_work_estimate;          /* How long we expect a clock cycle to take, based on recent cycles, in microseconds */
 
   guint flush_idle_id;
   guint paint_idle_id;
@@ -83,6 +90,13 @@ static gint64 sleep_serial;
 static gint64 sleep_source_prepare_time;
 static GSource *sleep_source;
 
+static guint update_misses_counter;
+static guint layout_misses_counter;
+static guint paint_misses_counter;
+static gint64 update_misses;
+static gint64 layout_misses;
+static gint64 paint_misses;
+
 static gboolean
 sleep_source_prepare (GSource *source,
                       int     *timeout)
@@ -142,6 +156,13 @@ gdk_frame_clock_idle_init (GdkFrameClockIdle *frame_clock_idle)
 
   priv->freeze_count = 0;
   priv->smoothed_frame_time_period = FRAME_INTERVAL;
+
+  if (update_misses_counter == 0)
+    {
+      update_misses_counter = gdk_profiler_define_int_counter ("update budget misses", "Frames where the update phase overran the frame budget");
+      layout_misses_counter = gdk_profiler_define_int_counter ("layout budget misses", "Frames where the layout phase overran the frame budget");
+      paint_misses_counter = gdk_profiler_define_int_counter ("paint budget misses", "Frames where the paint phase overran the frame budget");
+    }
 }
 
 static void
@@ -310,6 +331,27 @@ should_run_paint_idle (GdkFrameClockIdle *self)
           priv->updating_count > 0);
 }
 
+/* When the backend thaws us right after a vblank, we have a full
+ * refresh interval until the next one. Starting the frame right away
+ * means that input arriving while we wait for the vblank misses the
+ * frame, so instead we start the frame as late as we can afford,
+ * given how long recent frames took.
+ */
+static gint64
+compute_frame_pacing_delay (GdkFrameClockIdle *self)
+{
+  GdkFrameClockIdlePrivate *priv = self->priv;
+  gint64 delay;
+
+  if (priv->frame_work_estimate == 0 ||
+      !GDK_DEBUG_CHECK (FRAME_PACING))
+    return 0;
+
+  delay = priv->smoothed_frame_time_period - priv->frame_work_estimate - FRAME_PACING_MARGIN;
+
+  return CLAMP (delay, 0, priv->smoothed_frame_time_period / 2);
+}
+
 static void
 maybe_start_idle (GdkFrameClockIdle *self,
                   gboolean           caused_by_thaw)
@@ -319,6 +361,7 @@ maybe_start_idle (GdkFrameClockIdle *self,
   if (should_run_flush_idle (self) || should_run_paint_idle (self))
     {
       guint min_interval = 0;
+      gboolean paced = FALSE;
 
       if (priv->min_next_frame_time != 0 &&
           !GDK_DEBUG_CHECK (NO_VSYNC))
@@ -327,6 +370,12 @@ maybe_start_idle (GdkFrameClockIdle *self,
           gint64 min_interval_us = MAX (priv->min_next_frame_time, now) - now;
           min_interval = (min_interval_us + 500) / 1000;
         }
+      else if (caused_by_thaw &&
+               !GDK_DEBUG_CHECK (NO_VSYNC))
+        {
+          min_interval = compute_frame_pacing_delay (self) / 1000;
+          paced = min_interval > 0;
+        }
 
       if (priv->flush_idle_id == 0 && should_run_flush_idle (self))
         {
@@ -344,7 +393,9 @@ maybe_start_idle (GdkFrameClockIdle *self,
       if (!priv->in_paint_idle &&
 	  priv->paint_idle_id == 0 && should_run_paint_idle (self))
         {
-          priv->paint_is_thaw = caused_by_thaw;
+          /* A delayed paint no longer starts at the vblank, so its
+           * frame time must not be used to align to it. */
+          priv->paint_is_thaw = caused_by_thaw && !paced;
           priv->paint_idle_id = g_timeout_add_full (GDK_PRIORITY_REDRAW,
                                                     min_interval,
                                                     gdk_frame_clock_paint_idle,
@@ -421,6 +472,45 @@ positive_modulo (int i, int n)
   return (i % n + n) % n;
 }
 
+/* Records a budget miss for the first phase that makes the
+ * clock cycle take longer than a refresh interval.
+ */
+static void
+check_frame_budget (GdkFrameClockIdle *self,
+                    gint64             cycle_start,
+                    gboolean          *missed,
+                    guint              counter,
+                    gint64            *misses)
+{
+  GdkFrameClockIdlePrivate *priv = self->priv;
+
+  if (cycle_start == 0 || *missed)
+    return;
+
+  if (g_get_monotonic_time () - cycle_start <= priv->smoothed_frame_time_period)
+    return;
+
+  *missed = TRUE;
+  (*misses)++;
+  gdk_profiler_set_int_counter (counter, *misses);
+}
+
+static void
+update_frame_work_estimate (GdkFrameClockIdle *self,
+                            gint64             cycle_start)
+{
+  GdkFrameClockIdlePrivate *priv = self->priv;
+  gint64 duration;
+
+  duration = g_get_monotonic_time () - cycle_start;
+
+  /* React quickly to slow frames, but only slowly trust fast ones */
+  if (duration >= priv->frame_work_estimate)
+    priv->frame_work_estimate = duration;
+  else
+    priv->frame_work_estimate = (7 * priv->frame_work_estimate + duration) / 8;
+}
+
 static gboolean
 gdk_frame_clock_paint_idle (void *data)
 {
@@ -429,6 +519,8 @@ gdk_frame_clock_paint_idle (void *data)
   GdkFrameClockIdlePrivate *priv = clock_idle->priv;
   gboolean skip_to_resume_events;
   GdkFrameTimings *timings = NULL;
+  gint64 cycle_start = 0;
+  gboolean missed_budget = FALSE;
   gint64 before G_GNUC_UNUSED;
 
   before = GDK_PROFILER_CURRENT_TIME;
@@ -557,6 +649,7 @@ gdk_frame_clock_paint_idle (void *data)
               timings->slept_before = priv->sleep_serial != get_sleep_serial ();
 
               priv->phase = GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
+              cycle_start = g_get_monotonic_time ();
 
               /* We always emit ::before-paint and ::after-paint if
                * any of the intermediate phases are requested and
@@ -578,6 +671,8 @@ gdk_frame_clock_paint_idle (void *data)
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_UPDATE;
                   _gdk_frame_clock_emit_update (clock);
                 }
+              check_frame_budget (clock_idle, cycle_start, &missed_budget,
+                                  update_misses_counter, &update_misses);
             }
           G_GNUC_FALLTHROUGH;
 
@@ -611,6 +706,8 @@ gdk_frame_clock_paint_idle (void *data)
                 }
 	      if (iter == 5)
 		g_warning ("gdk-frame-clock: layout continuously requested, giving up after 4 tries");
+              check_frame_budget (clock_idle, cycle_start, &missed_budget,
+                                  layout_misses_counter, &layout_misses);
             }
           G_GNUC_FALLTHROUGH;
 
@@ -633,6 +730,8 @@ gdk_frame_clock_paint_idle (void *data)
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_PAINT;
                   _gdk_frame_clock_emit_paint (clock);
                 }
+              check_frame_budget (clock_idle, cycle_start, &missed_budget,
+                                  paint_misses_counter, &paint_misses);
             }
           G_GNUC_FALLTHROUGH;
 
@@ -641,6 +740,8 @@ gdk_frame_clock_paint_idle (void *data)
             {
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_AFTER_PAINT;
               _gdk_frame_clock_emit_after_paint (clock);
+              if (cycle_start != 0)
+                update_frame_work_estimate (clock_idle, cycle_start);
               /* the ::after-paint phase doesn't get repeated on freeze/thaw,
                */
               priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
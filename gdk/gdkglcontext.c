@@ -109,6 +109,7 @@ const GdkDebugKey gdk_gl_feature_keys[] = {
   { "external-objects", GDK_GL_FEATURE_EXTERNAL_OBJECTS, "GL_EXT_memory_object and GL_EXT_semaphore"},
   { "external-objects-win32", GDK_GL_FEATURE_EXTERNAL_OBJECTS_WIN32, "GL_EXT_memory_object_win32 and GL_EXT_semaphore_win32" },
   { "blend-func-extended", GDK_GL_FEATURE_BLEND_FUNC_EXTENDED, "GL_EXT_blend_func_extended" },
+  { "program-binary", GDK_GL_FEATURE_PROGRAM_BINARY, "GL_ARB_get_program_binary" },
 };
 
 typedef struct _GdkGLContextPrivate GdkGLContextPrivate;
@@ -1821,6 +1822,18 @@ gdk_gl_context_check_features (GdkGLContext *context)
       epoxy_has_gl_extension ("GL_EXT_blend_func_extended"))
     features |= GDK_GL_FEATURE_BLEND_FUNC_EXTENDED;
 
+  if (gdk_gl_context_check_version (context, "4.1", "3.0") ||
+      epoxy_has_gl_extension ("GL_ARB_get_program_binary") ||
+      epoxy_has_gl_extension ("GL_OES_get_program_binary"))
+    {
+      GLint n_formats = 0;
+
+      /* drivers may support the API without any binary format */
+      glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+      if (n_formats > 0)
+        features |= GDK_GL_FEATURE_PROGRAM_BINARY;
+    }
+
   return features;
 }
 
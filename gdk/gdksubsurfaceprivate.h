@@ -46,6 +46,11 @@ struct _GdkSubsurface
   gboolean above_parent;
   GdkSubsurface *sibling_above;
   GdkSubsurface *sibling_below;
+
+  /* Number of frames GSK waits before it offloads or raises
+   * the subsurface again, after it had to stop doing so */
+  guint offload_holdoff;
+  guint raise_holdoff;
 };
 
 struct _GdkSubsurfaceClass
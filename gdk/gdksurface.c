@@ -2258,6 +2258,7 @@ _gdk_windowing_got_event (GdkDisplay *display,
    */
   _gdk_event_queue_handle_motion_compression (display);
   gdk_event_queue_handle_scroll_compression (display);
+  gdk_event_queue_handle_touch_compression (display);
 
   if (event_surface)
     {
@@ -403,3 +403,122 @@ gdk_texture_downloader_download_bytes_with_planes (const GdkTextureDownloader *s
   return bytes;
 }
 
+typedef struct
+{
+  GdkTextureDownloader downloader;
+  gsize stride;
+} DownloadTaskData;
+
+static void
+download_task_data_free (gpointer data)
+{
+  DownloadTaskData *task_data = data;
+
+  gdk_texture_downloader_finish (&task_data->downloader);
+  g_free (task_data);
+}
+
+static void
+download_bytes_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      data,
+                       GCancellable *cancellable)
+{
+  DownloadTaskData *task_data = data;
+  GBytes *bytes;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  bytes = gdk_texture_downloader_download_bytes (&task_data->downloader, &task_data->stride);
+
+  g_task_return_pointer (task, bytes, (GDestroyNotify) g_bytes_unref);
+}
+
+/**
+ * gdk_texture_downloader_download_bytes_async:
+ * @self: the downloader
+ * @cancellable: (nullable): a `GCancellable` to cancel the operation
+ * @callback: (scope async): callback to call when the download is done
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronously downloads the texture pixels into a `GBytes`.
+ *
+ * The download and format conversion happen on a worker thread, so
+ * downloading large textures does not block the calling thread. For
+ * GL textures, the readback itself still needs to happen on the thread
+ * owning the GL context. For dmabuf textures, the readback is done in
+ * the main context, and only the conversion runs on the worker thread.
+ *
+ * The settings of @self are copied when this function is called, so
+ * changing them afterwards does not affect the ongoing download.
+ *
+ * Call [method@Gdk.TextureDownloader.download_bytes_finish] from @callback
+ * to get the result.
+ *
+ * This function cannot be used with a multiplanar format.
+ *
+ * Since: 4.22
+ */
+void
+gdk_texture_downloader_download_bytes_async (const GdkTextureDownloader *self,
+                                             GCancellable               *cancellable,
+                                             GAsyncReadyCallback         callback,
+                                             gpointer                    user_data)
+{
+  DownloadTaskData *task_data;
+  GTask *task;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (gdk_memory_format_get_n_planes (self->format) == 1);
+
+  task_data = g_new0 (DownloadTaskData, 1);
+  gdk_texture_downloader_init (&task_data->downloader, self->texture);
+  gdk_texture_downloader_set_format (&task_data->downloader, self->format);
+  gdk_texture_downloader_set_color_state (&task_data->downloader, self->color_state);
+
+  task = g_task_new (self->texture, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gdk_texture_downloader_download_bytes_async);
+  g_task_set_task_data (task, task_data, download_task_data_free);
+  g_task_run_in_thread (task, download_bytes_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gdk_texture_downloader_download_bytes_finish:
+ * @self: the downloader
+ * @result: the `GAsyncResult` passed to the callback
+ * @out_stride: (out): The stride of the resulting data in bytes
+ * @error: return location for an error
+ *
+ * Finishes a download started with
+ * [method@Gdk.TextureDownloader.download_bytes_async].
+ *
+ * Returns: (transfer full) (nullable): The downloaded pixels
+ *
+ * Since: 4.22
+ */
+GBytes *
+gdk_texture_downloader_download_bytes_finish (const GdkTextureDownloader  *self,
+                                              GAsyncResult                *result,
+                                              gsize                       *out_stride,
+                                              GError                     **error)
+{
+  DownloadTaskData *task_data;
+  GBytes *bytes;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (g_task_is_valid (result, self->texture), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gdk_texture_downloader_download_bytes_async, NULL);
+  g_return_val_if_fail (out_stride != NULL, NULL);
+
+  bytes = g_task_propagate_pointer (G_TASK (result), error);
+  if (bytes == NULL)
+    return NULL;
+
+  task_data = g_task_get_task_data (G_TASK (result));
+  *out_stride = task_data->stride;
+
+  return bytes;
+}
@@ -67,6 +67,18 @@ GBytes *                gdk_texture_downloader_download_bytes_with_planes
                                                                 (const GdkTextureDownloader     *self,
                                                                  gsize                           out_offsets[4],
                                                                  gsize                           out_strides[4]);
+GDK_AVAILABLE_IN_4_22
+void                    gdk_texture_downloader_download_bytes_async
+                                                                (const GdkTextureDownloader     *self,
+                                                                 GCancellable                   *cancellable,
+                                                                 GAsyncReadyCallback             callback,
+                                                                 gpointer                        user_data);
+GDK_AVAILABLE_IN_4_22
+GBytes *                gdk_texture_downloader_download_bytes_finish
+                                                                (const GdkTextureDownloader     *self,
+                                                                 GAsyncResult                   *result,
+                                                                 gsize                          *out_stride,
+                                                                 GError                        **error);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GdkTextureDownloader, gdk_texture_downloader_free)
 
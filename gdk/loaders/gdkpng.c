@@ -93,6 +93,37 @@ png_flush_func (png_structp png)
 {
 }
 
+typedef struct
+{
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *error;
+} png_stream_io;
+
+static void
+png_stream_write_func (png_structp png,
+                       png_bytep   data,
+                       png_size_t  size)
+{
+  png_stream_io *io;
+
+  io = png_get_io_ptr (png);
+
+  if (!g_output_stream_write_all (io->stream, data, size, NULL, io->cancellable, &io->error))
+    png_error (png, io->error->message);
+}
+
+static void
+png_stream_flush_func (png_structp png)
+{
+  png_stream_io *io;
+
+  io = png_get_io_ptr (png);
+
+  if (!g_output_stream_flush (io->stream, io->cancellable, &io->error))
+    png_error (png, io->error->message);
+}
+
 static png_voidp
 png_malloc_callback (png_structp o,
                      png_size_t  size)
@@ -503,13 +534,19 @@ gdk_load_png (GBytes      *bytes,
   return texture;
 }
 
-GBytes *
-gdk_save_png (GdkTexture *texture,
-              GHashTable *options)
+/* Writes the encoded png via @write_func as it is produced, so
+ * callers that have a stream don't need to hold the whole file
+ * in memory.
+ */
+static gboolean
+gdk_save_png_with_writer (GdkTexture   *texture,
+                          GHashTable   *options,
+                          gpointer      io_ptr,
+                          png_rw_ptr    write_func,
+                          png_flush_ptr flush_func)
 {
   png_struct *png = NULL;
   png_info *info;
-  png_io io = { NULL, 0, 0 };
   int width, height;
   int y;
   GdkMemoryFormat format;
@@ -647,7 +684,7 @@ gdk_save_png (GdkTexture *texture,
                                    png_malloc_callback,
                                    png_free_callback);
   if (!png)
-    return NULL;
+    return FALSE;
 
   /* 2^31-1 is the maximum size for PNG files */
   png_set_user_limits (png, (1u << 31) - 1, (1u << 31) - 1);
@@ -658,7 +695,7 @@ gdk_save_png (GdkTexture *texture,
   if (!info)
     {
       png_destroy_read_struct (&png, NULL, NULL);
-      return NULL;
+      return FALSE;
     }
 
   gdk_color_state_ref (color_state);
@@ -668,12 +705,11 @@ gdk_save_png (GdkTexture *texture,
     {
       gdk_color_state_unref (color_state);
       g_clear_pointer (&bytes, g_bytes_unref);
-      g_free (io.data);
       png_destroy_read_struct (&png, &info, NULL);
-      return NULL;
+      return FALSE;
     }
 
-  png_set_write_fn (png, &io, png_write_func, png_flush_func);
+  png_set_write_fn (png, io_ptr, write_func, flush_func);
 
   png_set_IHDR (png, info, width, height, depth,
                 png_format,
@@ -743,9 +779,47 @@ gdk_save_png (GdkTexture *texture,
 
   g_free (text_ptr);
 
+  return TRUE;
+}
+
+GBytes *
+gdk_save_png (GdkTexture *texture,
+              GHashTable *options)
+{
+  png_io io = { NULL, 0, 0 };
+
+  if (!gdk_save_png_with_writer (texture, options, &io, png_write_func, png_flush_func))
+    {
+      g_free (io.data);
+      return NULL;
+    }
+
   return g_bytes_new_take (io.data, io.size);
 }
 
+gboolean
+gdk_save_png_to_stream (GdkTexture     *texture,
+                        GHashTable     *options,
+                        GOutputStream  *stream,
+                        GCancellable   *cancellable,
+                        GError        **error)
+{
+  png_stream_io io = { stream, cancellable, NULL };
+
+  if (!gdk_save_png_with_writer (texture, options, &io, png_stream_write_func, png_stream_flush_func))
+    {
+      if (io.error)
+        g_propagate_error (error, io.error);
+      else
+        g_set_error_literal (error,
+                             GDK_TEXTURE_ERROR, GDK_TEXTURE_ERROR_CORRUPT_IMAGE,
+                             _("Failed to save png"));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 /* }}} */
 
 /* vim:set foldmethod=marker: */
@@ -28,6 +28,12 @@ GdkTexture *gdk_load_png        (GBytes         *bytes,
 
 GBytes     *gdk_save_png        (GdkTexture     *texture,
                                  GHashTable     *options);
+gboolean    gdk_save_png_to_stream
+                                (GdkTexture     *texture,
+                                 GHashTable     *options,
+                                 GOutputStream  *stream,
+                                 GCancellable   *cancellable,
+                                 GError        **error);
 
 static inline gboolean
 gdk_is_png (GBytes *bytes)
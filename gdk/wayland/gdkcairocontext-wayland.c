@@ -22,9 +22,16 @@
 
 #include "gdksurface-wayland-private.h"
 #include "gdkshm-private.h"
+#include "gdkcairoprivate.h"
 
 #include "gdkprofilerprivate.h"
 
+/* We keep up to this many buffers that the compositor has released
+ * around for reuse, so that triple buffering works without
+ * allocating new shm buffers every frame.
+ */
+#define MAX_CACHED_SURFACES 2
+
 static const cairo_user_data_key_t gdk_wayland_cairo_context_key;
 static const cairo_user_data_key_t gdk_wayland_cairo_region_key;
 
@@ -100,10 +107,10 @@ gdk_wayland_cairo_context_buffer_release (void             *_data,
   if (self == NULL)
     return;
 
-  /* Cache one surface for reuse when drawing */
-  if (self->cached_surface == NULL)
+  /* Cache a few surfaces for reuse when drawing */
+  if (g_slist_length (self->cached_surfaces) < MAX_CACHED_SURFACES)
     {
-      self->cached_surface = cairo_surface;
+      self->cached_surfaces = g_slist_prepend (self->cached_surfaces, cairo_surface);
       return;
     }
 
@@ -141,6 +148,36 @@ gdk_wayland_cairo_context_create_surface (GdkWaylandCairoContext *self)
   return cairo_surface;
 }
 
+/* Picks the cached surface with the least damage accumulated
+ * since it was last painted, ie the one that was used most
+ * recently, so that we need to repaint as little as possible.
+ */
+static cairo_surface_t *
+gdk_wayland_cairo_context_steal_cached_surface (GdkWaylandCairoContext *self)
+{
+  cairo_surface_t *best = NULL;
+  gint64 best_pixels = G_MAXINT64;
+  GSList *l;
+
+  for (l = self->cached_surfaces; l; l = l->next)
+    {
+      const cairo_region_t *region;
+      gint64 pixels;
+
+      region = gdk_wayland_cairo_context_surface_get_region (l->data);
+      pixels = region ? gdk_cairo_region_get_pixels (region) : 0;
+      if (pixels < best_pixels)
+        {
+          best = l->data;
+          best_pixels = pixels;
+        }
+    }
+
+  self->cached_surfaces = g_slist_remove (self->cached_surfaces, best);
+
+  return best;
+}
+
 static void
 gdk_wayland_cairo_context_begin_frame (GdkDrawContext  *draw_context,
                                        gpointer         context_data,
@@ -155,8 +192,8 @@ gdk_wayland_cairo_context_begin_frame (GdkDrawContext  *draw_context,
   cairo_t *cr;
   GdkSurface *surface = gdk_draw_context_get_surface (draw_context);
 
-  if (self->cached_surface)
-    self->paint_surface = g_steal_pointer (&self->cached_surface);
+  if (self->cached_surfaces)
+    self->paint_surface = gdk_wayland_cairo_context_steal_cached_surface (self);
   else
     self->paint_surface = gdk_wayland_cairo_context_create_surface (self);
 
@@ -211,7 +248,7 @@ gdk_wayland_cairo_context_empty_frame (GdkDrawContext *draw_context)
 static void
 gdk_wayland_cairo_context_clear_all_cairo_surfaces (GdkWaylandCairoContext *self)
 {
-  g_clear_pointer (&self->cached_surface, cairo_surface_destroy);
+  g_slist_free_full (g_steal_pointer (&self->cached_surfaces), (GDestroyNotify) cairo_surface_destroy);
   while (self->surfaces)
     gdk_wayland_cairo_context_remove_surface (self, self->surfaces->data);
 }
@@ -238,7 +275,7 @@ gdk_wayland_cairo_context_dispose (GObject *object)
   GdkWaylandCairoContext *self = GDK_WAYLAND_CAIRO_CONTEXT (object);
 
   gdk_wayland_cairo_context_clear_all_cairo_surfaces (self);
-  g_assert (self->cached_surface == NULL);
+  g_assert (self->cached_surfaces == NULL);
   g_assert (self->paint_surface == NULL);
 
   G_OBJECT_CLASS (gdk_wayland_cairo_context_parent_class)->dispose (object);
@@ -39,7 +39,7 @@ struct _GdkWaylandCairoContext
   GdkCairoContext parent_instance;
 
   GSList *surfaces;
-  cairo_surface_t *cached_surface;
+  GSList *cached_surfaces;
   cairo_surface_t *paint_surface;
 };
 
@@ -13,6 +13,7 @@
 #include "gdk/gdkprofilerprivate.h"
 
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
 
 struct _GskGLDevice
 {
@@ -22,6 +23,14 @@ struct _GskGLDevice
   const char *version_string;
   GdkGLAPI api;
 
+  /* checksum of the shader sources => (format, binary) */
+  GHashTable *program_binaries;
+  /* the subset of program_binaries used by this process */
+  GHashTable *used_program_binaries;
+  char *program_cache_name;
+  guint save_program_cache_source;
+  guint has_program_binaries : 1;
+
   guint sampler_ids[GSK_GPU_SAMPLER_N_SAMPLERS];
 };
 
@@ -40,6 +49,11 @@ struct _GLProgramKey
   guint32 variation;
 };
 
+#define GL_PROGRAM_CACHE_FORMAT "a{s(uay)}"
+
+/* cache files of other drivers that weren't touched in that time get removed */
+#define GL_PROGRAM_CACHE_MAX_AGE (30 * G_TIME_SPAN_DAY)
+
 G_DEFINE_TYPE (GskGLDevice, gsk_gl_device, GSK_TYPE_GPU_DEVICE)
 
 static guint
@@ -139,6 +153,215 @@ gsk_gl_device_make_current (GskGpuDevice *device)
   gdk_gl_context_make_current (gdk_display_get_gl_context (gsk_gpu_device_get_display (device)));
 }
 
+static char *
+gsk_gl_device_get_program_cache_dirname (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "gl-program-cache", NULL);
+}
+
+static GFile *
+gsk_gl_device_get_program_cache_file (GskGLDevice *self)
+{
+  char *dirname, *path;
+  GFile *result;
+
+  dirname = gsk_gl_device_get_program_cache_dirname ();
+  path = g_build_filename (dirname, self->program_cache_name, NULL);
+  result = g_file_new_for_path (path);
+
+  g_free (path);
+  g_free (dirname);
+
+  return result;
+}
+
+/* Program binaries are only valid for the exact driver that produced
+ * them, so every driver gets its own cache file.
+ */
+static char *
+gsk_gl_device_compute_program_cache_name (void)
+{
+  const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  GChecksum *checksum;
+  char *result;
+  guint i;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      const char *s = (const char *) glGetString (names[i]);
+
+      if (s)
+        g_checksum_update (checksum, (const guchar *) s, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+    }
+  result = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return result;
+}
+
+static void
+gsk_gl_device_load_program_cache (GskGLDevice *self)
+{
+  GError *error = NULL;
+  GVariantIter iter;
+  GVariant *cache, *entry;
+  GBytes *bytes;
+  GFile *file;
+  const char *checksum;
+
+  file = gsk_gl_device_get_program_cache_file (self);
+  bytes = g_file_load_bytes (file, NULL, NULL, &error);
+  if (bytes == NULL)
+    {
+      GSK_DEBUG (SHADERS, "Failed to load GL program cache '%s': %s",
+                 g_file_peek_path (file), error->message);
+      g_clear_error (&error);
+      g_object_unref (file);
+      return;
+    }
+
+  cache = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (GL_PROGRAM_CACHE_FORMAT), bytes, FALSE));
+
+  g_variant_iter_init (&iter, cache);
+  while (g_variant_iter_next (&iter, "{&s@(uay)}", &checksum, &entry))
+    g_hash_table_insert (self->program_binaries, g_strdup (checksum), entry);
+
+  GSK_DEBUG (SHADERS, "Loaded %u GL program binaries from %s",
+             g_hash_table_size (self->program_binaries), g_file_peek_path (file));
+
+  /* mark the file as in use, see gsk_gl_device_remove_stale_program_caches() */
+  g_utime (g_file_peek_path (file), NULL);
+
+  g_variant_unref (cache);
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+}
+
+/* Every driver update leaves behind a cache file that will never be
+ * used again. Files that are in use get touched when loading them, so
+ * we can just go by their age. That keeps the caches of multiple GPUs
+ * around.
+ */
+static void
+gsk_gl_device_remove_stale_program_caches (GskGLDevice *self,
+                                           const char  *dirname)
+{
+  const char *name;
+  GDir *dir;
+  gint64 now;
+
+  dir = g_dir_open (dirname, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  now = g_get_real_time ();
+  while ((name = g_dir_read_name (dir)))
+    {
+      GStatBuf buf;
+      char *path;
+
+      if (g_str_equal (name, self->program_cache_name))
+        continue;
+
+      path = g_build_filename (dirname, name, NULL);
+      if (g_stat (path, &buf) == 0 &&
+          now - (gint64) buf.st_mtime * G_USEC_PER_SEC > GL_PROGRAM_CACHE_MAX_AGE)
+        {
+          GSK_DEBUG (SHADERS, "Removing stale GL program cache %s", path);
+          g_remove (path);
+        }
+      g_free (path);
+    }
+
+  g_dir_close (dir);
+}
+
+static gboolean
+gsk_gl_device_save_program_cache (GskGLDevice *self)
+{
+  G_GNUC_UNUSED gint64 begin_time = GDK_PROFILER_CURRENT_TIME;
+  GError *error = NULL;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  gpointer key, value;
+  GVariant *cache;
+  GFile *file;
+  char *path;
+
+  path = gsk_gl_device_get_program_cache_dirname ();
+  if (g_mkdir_with_parents (path, 0755) != 0)
+    {
+      g_warning_once ("Failed to create GL program cache directory");
+      g_free (path);
+      return FALSE;
+    }
+  gsk_gl_device_remove_stale_program_caches (self, path);
+  g_free (path);
+
+  /* Only write what this process used, so programs that went away
+   * with a GTK update don't stay in the cache forever. */
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (GL_PROGRAM_CACHE_FORMAT));
+  g_hash_table_iter_init (&iter, self->used_program_binaries);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    g_variant_builder_add (&builder, "{s@(uay)}", key, value);
+  cache = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  file = gsk_gl_device_get_program_cache_file (self);
+
+  GSK_DEBUG (SHADERS, "Saving %u GL program binaries to %s",
+             g_hash_table_size (self->used_program_binaries), g_file_peek_path (file));
+
+  if (!g_file_replace_contents (file,
+                                g_variant_get_data (cache),
+                                g_variant_get_size (cache),
+                                NULL,
+                                FALSE,
+                                0,
+                                NULL,
+                                NULL,
+                                &error))
+    {
+      g_warning ("Failed to save GL program cache: %s", error->message);
+      g_clear_error (&error);
+      g_object_unref (file);
+      g_variant_unref (cache);
+      return FALSE;
+    }
+
+  gdk_profiler_end_markf (begin_time,
+                          "Save GL program cache", "%s size %" G_GSIZE_FORMAT,
+                          g_file_peek_path (file), g_variant_get_size (cache));
+
+  g_object_unref (file);
+  g_variant_unref (cache);
+
+  return TRUE;
+}
+
+static gboolean
+gsk_gl_device_save_program_cache_cb (gpointer data)
+{
+  GskGLDevice *self = data;
+
+  gsk_gl_device_save_program_cache (self);
+
+  self->save_program_cache_source = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gsk_gl_device_program_cache_updated (GskGLDevice *self)
+{
+  g_clear_handle_id (&self->save_program_cache_source, g_source_remove);
+  self->save_program_cache_source = g_timeout_add_seconds_full (G_PRIORITY_DEFAULT_IDLE - 10,
+                                                                10, /* same as the Vulkan pipeline cache */
+                                                                gsk_gl_device_save_program_cache_cb,
+                                                                self,
+                                                                NULL);
+}
+
 static void
 gsk_gl_device_finalize (GObject *object)
 {
@@ -147,6 +370,15 @@ gsk_gl_device_finalize (GObject *object)
 
   g_object_steal_data (G_OBJECT (gsk_gpu_device_get_display (device)), "-gsk-gl-device");
 
+  if (self->save_program_cache_source)
+    {
+      g_clear_handle_id (&self->save_program_cache_source, g_source_remove);
+      gsk_gl_device_save_program_cache (self);
+    }
+  g_hash_table_unref (self->used_program_binaries);
+  g_hash_table_unref (self->program_binaries);
+  g_free (self->program_cache_name);
+
   gdk_gl_context_make_current (gdk_display_get_gl_context (gsk_gpu_device_get_display (device)));
 
   g_hash_table_unref (self->gl_programs);
@@ -180,6 +412,8 @@ static void
 gsk_gl_device_init (GskGLDevice *self)
 {
   self->gl_programs = g_hash_table_new_full (gl_program_key_hash, gl_program_key_equal, g_free, free_gl_program);
+  self->program_binaries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+  self->used_program_binaries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
 }
 
 static void
@@ -276,6 +510,13 @@ gsk_gl_device_get_for_display (GdkDisplay  *display,
   self->api = gdk_gl_context_get_api (context);
   gsk_gl_device_setup_samplers (self);
 
+  self->has_program_binaries = gdk_gl_context_has_feature (context, GDK_GL_FEATURE_PROGRAM_BINARY);
+  if (self->has_program_binaries)
+    {
+      self->program_cache_name = gsk_gl_device_compute_program_cache_name ();
+      gsk_gl_device_load_program_cache (self);
+    }
+
   g_object_set_data (G_OBJECT (display), "-gsk-gl-device", self);
 
   return GSK_GPU_DEVICE (self);
@@ -395,19 +636,20 @@ gsk_gl_device_has_gl_feature (GskGLDevice   *self,
   return gdk_gl_context_has_feature (context, feature);
 }
 
-static GLuint
-gsk_gl_device_load_shader (GskGLDevice       *self,
-                           const char        *program_name,
-                           GLenum             shader_type,
-                           GskGpuShaderFlags  flags,
-                           GskGpuColorStates  color_states,
-                           guint32            variation,
-                           GError           **error)
+static char *
+gsk_gl_device_get_shader_source (GskGLDevice       *self,
+                                 const char        *program_name,
+                                 GLenum             shader_type,
+                                 GskGpuShaderFlags  flags,
+                                 GskGpuColorStates  color_states,
+                                 guint32            variation,
+                                 GError           **error)
 {
   GString *preamble;
   char *resource_name;
   GBytes *bytes;
-  GLuint shader_id;
+  gconstpointer data;
+  gsize size;
 
   preamble = g_string_new (NULL);
 
@@ -447,7 +689,7 @@ gsk_gl_device_load_shader (GskGLDevice       *self,
 
       default:
         g_assert_not_reached ();
-        return 0;
+        return NULL;
     }
 
   g_string_append_printf (preamble, "#define GSK_FLAGS %uu\n", flags);
@@ -458,20 +700,30 @@ gsk_gl_device_load_shader (GskGLDevice       *self,
   bytes = g_resources_lookup_data (resource_name, 0, error);
   g_free (resource_name);
   if (bytes == NULL)
-    return 0;
+    {
+      g_string_free (preamble, TRUE);
+      return NULL;
+    }
 
-  shader_id = glCreateShader (shader_type);
+  data = g_bytes_get_data (bytes, &size);
+  g_string_append_len (preamble, data, size);
+  g_bytes_unref (bytes);
+
+  return g_string_free (preamble, FALSE);
+}
 
-  glShaderSource (shader_id,
-                  2,
-                  (const char *[]) {
-                    preamble->str,
-                    g_bytes_get_data (bytes, NULL),
-                  },
-                  NULL);
+static GLuint
+gsk_gl_device_compile_shader (GskGLDevice  *self,
+                              const char   *program_name,
+                              GLenum        shader_type,
+                              const char   *source,
+                              GError      **error)
+{
+  GLuint shader_id;
 
-  g_bytes_unref (bytes);
-  g_string_free (preamble, TRUE);
+  shader_id = glCreateShader (shader_type);
+
+  glShaderSource (shader_id, 1, &source, NULL);
 
   glCompileShader (shader_id);
 
@@ -486,6 +738,93 @@ gsk_gl_device_load_shader (GskGLDevice       *self,
   return shader_id;
 }
 
+static char *
+gsk_gl_device_compute_program_checksum (const GskGpuShaderOpClass *op_class,
+                                        const char                *vertex_source,
+                                        const char                *fragment_source)
+{
+  GChecksum *checksum;
+  char *result;
+
+  /* include the terminating NUL bytes as separators */
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) op_class->shader_name, strlen (op_class->shader_name) + 1);
+  g_checksum_update (checksum, (const guchar *) vertex_source, strlen (vertex_source) + 1);
+  g_checksum_update (checksum, (const guchar *) fragment_source, strlen (fragment_source) + 1);
+  result = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return result;
+}
+
+static GLuint
+gsk_gl_device_load_program_binary (GskGLDevice *self,
+                                   const char  *checksum)
+{
+  GVariant *entry, *binary;
+  gconstpointer data;
+  gsize size;
+  guint32 format;
+  GLuint program_id;
+  GLint link_status;
+
+  entry = g_hash_table_lookup (self->program_binaries, checksum);
+  if (entry == NULL)
+    return 0;
+
+  g_variant_get (entry, "(u@ay)", &format, &binary);
+  data = g_variant_get_fixed_array (binary, &size, sizeof (guchar));
+
+  program_id = glCreateProgram ();
+  glProgramBinary (program_id, format, data, size);
+
+  g_variant_unref (binary);
+
+  glGetProgramiv (program_id, GL_LINK_STATUS, &link_status);
+  if (link_status == GL_FALSE)
+    {
+      /* The driver is free to reject binaries at any time, just compile
+       * the program again in that case. */
+      GSK_DEBUG (SHADERS, "Discarding GL program binary %s", checksum);
+      glDeleteProgram (program_id);
+      g_hash_table_remove (self->program_binaries, checksum);
+      return 0;
+    }
+
+  g_hash_table_insert (self->used_program_binaries, g_strdup (checksum), g_variant_ref (entry));
+
+  return program_id;
+}
+
+static void
+gsk_gl_device_store_program_binary (GskGLDevice *self,
+                                    const char  *checksum,
+                                    GLuint       program_id)
+{
+  GLint length = 0;
+  GLenum format;
+  guchar *data;
+  GVariant *entry;
+
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  data = g_malloc (length);
+  glGetProgramBinary (program_id, length, &length, &format, data);
+
+  entry = g_variant_new ("(u@ay)",
+                         (guint32) format,
+                         g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, data, length, sizeof (guchar)));
+  g_free (data);
+
+  g_variant_ref_sink (entry);
+  g_hash_table_insert (self->program_binaries, g_strdup (checksum), g_variant_ref (entry));
+  g_hash_table_insert (self->used_program_binaries, g_strdup (checksum), entry);
+
+  gsk_gl_device_program_cache_updated (self);
+}
+
 static GLuint
 gsk_gl_device_load_program (GskGLDevice               *self,
                             const GskGpuShaderOpClass *op_class,
@@ -496,15 +835,55 @@ gsk_gl_device_load_program (GskGLDevice               *self,
 {
   G_GNUC_UNUSED gint64 begin_time = GDK_PROFILER_CURRENT_TIME;
   GLuint vertex_shader_id, fragment_shader_id, program_id;
+  char *vertex_source, *fragment_source;
+  char *checksum = NULL;
   GLint link_status;
 
-  vertex_shader_id = gsk_gl_device_load_shader (self, op_class->shader_name, GL_VERTEX_SHADER, flags, color_states, variation, error);
-  if (vertex_shader_id == 0)
+  vertex_source = gsk_gl_device_get_shader_source (self, op_class->shader_name, GL_VERTEX_SHADER, flags, color_states, variation, error);
+  if (vertex_source == NULL)
     return 0;
 
-  fragment_shader_id = gsk_gl_device_load_shader (self, op_class->shader_name, GL_FRAGMENT_SHADER, flags, color_states, variation, error);
+  fragment_source = gsk_gl_device_get_shader_source (self, op_class->shader_name, GL_FRAGMENT_SHADER, flags, color_states, variation, error);
+  if (fragment_source == NULL)
+    {
+      g_free (vertex_source);
+      return 0;
+    }
+
+  if (self->has_program_binaries)
+    {
+      checksum = gsk_gl_device_compute_program_checksum (op_class, vertex_source, fragment_source);
+      program_id = gsk_gl_device_load_program_binary (self, checksum);
+      if (program_id)
+        {
+          gdk_profiler_end_markf (begin_time,
+                                  "Load Program Binary",
+                                  "name=%s id=%u",
+                                  op_class->shader_name, program_id);
+          g_free (checksum);
+          g_free (vertex_source);
+          g_free (fragment_source);
+          return program_id;
+        }
+    }
+
+  vertex_shader_id = gsk_gl_device_compile_shader (self, op_class->shader_name, GL_VERTEX_SHADER, vertex_source, error);
+  g_free (vertex_source);
+  if (vertex_shader_id == 0)
+    {
+      g_free (fragment_source);
+      g_free (checksum);
+      return 0;
+    }
+
+  fragment_shader_id = gsk_gl_device_compile_shader (self, op_class->shader_name, GL_FRAGMENT_SHADER, fragment_source, error);
+  g_free (fragment_source);
   if (fragment_shader_id == 0)
-    return 0;
+    {
+      glDeleteShader (vertex_shader_id);
+      g_free (checksum);
+      return 0;
+    }
 
   program_id = glCreateProgram ();
 
@@ -513,6 +892,9 @@ gsk_gl_device_load_program (GskGLDevice               *self,
 
   op_class->setup_attrib_locations (program_id);
 
+  if (self->has_program_binaries)
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
   glLinkProgram (program_id);
 
   glGetProgramiv (program_id, GL_LINK_STATUS, &link_status);
@@ -545,10 +927,17 @@ gsk_gl_device_load_program (GskGLDevice               *self,
       g_free (buffer);
 
       glDeleteProgram (program_id);
+      g_free (checksum);
 
       return 0;
     }
 
+  if (checksum)
+    {
+      gsk_gl_device_store_program_binary (self, checksum, program_id);
+      g_free (checksum);
+    }
+
   gdk_profiler_end_markf (begin_time,
                           "Compile Program",
                           "name=%s id=%u frag=%u vert=%u",
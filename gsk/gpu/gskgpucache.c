@@ -4,6 +4,7 @@
 
 #include "gskgpucachedglyphprivate.h"
 #include "gskgpucachedfillprivate.h"
+#include "gskgpucachednodeprivate.h"
 #include "gskgpucachedstrokeprivate.h"
 #include "gskgpucachedprivate.h"
 #include "gskgpudeviceprivate.h"
@@ -29,6 +30,11 @@
 
 #define ATLAS_TIMEOUT_SCALE 4
 
+/* The number of pixels of texture tiles we keep around before
+ * evicting the tiles that weren't used for the longest time.
+ */
+#define MAX_TILE_PIXELS (64 * 1024 * 1024)
+
 G_STATIC_ASSERT (MAX_ATLAS_ITEM_SIZE < ATLAS_SIZE);
 G_STATIC_ASSERT (MIN_ALIVE_PIXELS < ATLAS_SIZE * ATLAS_SIZE);
 
@@ -49,6 +55,8 @@ struct _GskGpuCache
   GHashTable *texture_cache;
   GHashTable *ccs_texture_caches[GDK_COLOR_STATE_N_IDS];
   GHashTable *tile_cache;
+  gsize tile_pixels;
+  gint64 tile_evict_timestamp;
 
   GskGpuCachedAtlas *current_atlas;
 
@@ -545,6 +553,8 @@ gsk_gpu_cached_tile_free (GskGpuCached *cached)
   g_clear_object (&self->image);
   g_clear_pointer (&self->color_state, gdk_color_state_unref);
 
+  cache->tile_pixels -= cached->pixels;
+
   if (g_hash_table_steal_extended (cache->tile_cache, self, &key, &value))
     {
       /* If the texture has been reused already, we put the entry back */
@@ -655,6 +665,7 @@ gsk_gpu_cached_tile_new (GskGpuCache   *cache,
   self->dead_textures_counter = &cache->dead_textures;
   self->dead_pixels_counter = &cache->dead_texture_pixels;
   self->use_count = 2;
+  cache->tile_pixels += ((GskGpuCached *)self)->pixels;
 
   g_object_weak_ref (G_OBJECT (texture), (GWeakNotify) gsk_gpu_cached_tile_destroy_cb, self);
   if (cache->tile_cache == NULL)
@@ -695,6 +706,59 @@ gsk_gpu_cache_lookup_tile (GskGpuCache      *self,
   return g_object_ref (tile->image);
 }
 
+static int
+gsk_gpu_cached_compare_timestamp (gconstpointer a,
+                                  gconstpointer b)
+{
+  const GskGpuCached *cached_a = *(const GskGpuCached **) a;
+  const GskGpuCached *cached_b = *(const GskGpuCached **) b;
+
+  if (cached_a->timestamp < cached_b->timestamp)
+    return -1;
+  else if (cached_a->timestamp > cached_b->timestamp)
+    return 1;
+  else
+    return 0;
+}
+
+/* Evicts the least recently used tiles until we are below
+ * MAX_TILE_PIXELS again. Tiles used in the current frame are
+ * kept, so huge textures still render, they just don't keep
+ * more than the visible tiles around.
+ */
+static void
+gsk_gpu_cache_evict_tiles (GskGpuCache *self)
+{
+  GskGpuCached *cached;
+  GPtrArray *tiles;
+  guint i;
+
+  if (self->tile_pixels <= MAX_TILE_PIXELS)
+    return;
+
+  /* We already evicted everything we could this frame */
+  if (self->tile_evict_timestamp == self->timestamp)
+    return;
+  self->tile_evict_timestamp = self->timestamp;
+
+  tiles = g_ptr_array_new ();
+  for (cached = self->first_cached; cached != NULL; cached = cached->next)
+    {
+      if (cached->class == &GSK_GPU_CACHED_TILE_CLASS &&
+          cached->timestamp < self->timestamp)
+        g_ptr_array_add (tiles, cached);
+    }
+
+  g_ptr_array_sort (tiles, gsk_gpu_cached_compare_timestamp);
+
+  for (i = 0; i < tiles->len && self->tile_pixels > MAX_TILE_PIXELS; i++)
+    gsk_gpu_cached_free (g_ptr_array_index (tiles, i));
+
+  GSK_DEBUG (CACHE, "Evicted %u tiles, %" G_GSIZE_FORMAT " tile pixels remaining", i, self->tile_pixels);
+
+  g_ptr_array_unref (tiles);
+}
+
 void
 gsk_gpu_cache_cache_tile (GskGpuCache      *self,
                           GdkTexture       *texture,
@@ -715,6 +779,8 @@ gsk_gpu_cache_cache_tile (GskGpuCache      *self,
                                   color_state);
 
   gsk_gpu_cached_use ((GskGpuCached *) tile);
+
+  gsk_gpu_cache_evict_tiles (self);
 }
 
 /* }}} */
@@ -750,6 +816,7 @@ typedef struct
 static void
 print_cache_stats (GskGpuCache *self)
 {
+  GskGpuCachePrivate *priv = gsk_gpu_cache_get_private (self);
   GskGpuCached *cached;
   GString *message;
   GString *ratios = g_string_new ("");
@@ -799,6 +866,18 @@ print_cache_stats (GskGpuCache *self)
         g_string_append_printf (message, "%s", ratios->str);
       else if (class == &GSK_GPU_CACHED_TEXTURE_CLASS)
         g_string_append_printf (message, " (%u in hash)", g_hash_table_size (self->texture_cache));
+      else if (class == &GSK_GPU_CACHED_TILE_CLASS)
+        g_string_append_printf (message, " (%" G_GSIZE_FORMAT " pixels)", self->tile_pixels);
+    }
+
+  if (priv->node_cache_hits + priv->node_cache_misses > 0)
+    {
+      g_string_append_printf (message, "\n  Retained nodes: %u hits, %u misses (%.1f%% hit rate, %" G_GSIZE_FORMAT " pixels)",
+                              priv->node_cache_hits, priv->node_cache_misses,
+                              100.0 * priv->node_cache_hits / (priv->node_cache_hits + priv->node_cache_misses),
+                              priv->node_cache_pixels);
+      priv->node_cache_hits = 0;
+      priv->node_cache_misses = 0;
     }
 
   gdk_debug_message ("%s", message->str);
@@ -881,6 +960,7 @@ gsk_gpu_cache_dispose (GObject *object)
 
   gsk_gpu_cache_clear_cache (self);
 
+  gsk_gpu_cached_node_finish_cache (self);
   gsk_gpu_cached_stroke_finish_cache (self);
   gsk_gpu_cached_fill_finish_cache (self);
 
@@ -928,6 +1008,7 @@ gsk_gpu_cache_init (GskGpuCache *self)
 #endif
   gsk_gpu_cached_fill_init_cache (self);
   gsk_gpu_cached_stroke_init_cache (self);
+  gsk_gpu_cached_node_init_cache (self);
 }
 
 GskGpuImage *
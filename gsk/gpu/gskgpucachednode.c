@@ -0,0 +1,247 @@
+#include "config.h"
+
+#include "gskgpucachednodeprivate.h"
+
+#include "gskgpucacheprivate.h"
+#include "gskgpucachedprivate.h"
+#include "gskgpuframeprivate.h"
+#include "gskgpuimageprivate.h"
+#include "gskrectprivate.h"
+
+#include "gdk/gdkcolorstateprivate.h"
+
+/* Upper limit for the pixels of all retained nodes together,
+ * roughly two 4k screens worth of offscreens.
+ */
+#define MAX_RETAINED_PIXELS (2 * 3840 * 2160)
+
+/* Nodes that were not seen for this long are no longer
+ * considered candidates for retaining.
+ */
+#define CANDIDATE_TIMEOUT G_TIME_SPAN_SECOND
+
+typedef struct _GskGpuCachedNode GskGpuCachedNode;
+typedef struct _Candidate Candidate;
+
+struct _GskGpuCachedNode
+{
+  GskGpuCached parent;
+
+  GskRenderNode *node;
+  GdkColorState *ccs;
+  float sx, sy;
+  graphene_rect_t bounds;
+
+  GskGpuImage *image;
+};
+
+/* Nodes seen in earlier frames. The nodes are not reffed, so the
+ * pointers are only compared, never dereferenced.
+ */
+struct _Candidate
+{
+  gint64 timestamp;
+  float sx, sy;
+  graphene_rect_t bounds;
+};
+
+static void
+gsk_gpu_cached_node_free (GskGpuCached *cached)
+{
+  GskGpuCachedNode *self = (GskGpuCachedNode *) cached;
+  GskGpuCachePrivate *priv = gsk_gpu_cache_get_private (cached->cache);
+
+  g_hash_table_remove (priv->node_cache, self);
+  priv->node_cache_pixels -= cached->pixels;
+
+  gsk_render_node_unref (self->node);
+  gdk_color_state_unref (self->ccs);
+  g_object_unref (self->image);
+
+  g_free (self);
+}
+
+static gboolean
+gsk_gpu_cached_node_should_collect (GskGpuCached *cached,
+                                    gint64        cache_timeout,
+                                    gint64        timestamp)
+{
+  return gsk_gpu_cached_is_old (cached, cache_timeout, timestamp);
+}
+
+static guint
+gsk_gpu_cached_node_hash (gconstpointer data)
+{
+  const GskGpuCachedNode *self = data;
+
+  return GPOINTER_TO_UINT (self->node) ^
+         (((guint) (self->sx * 16)) << 16) ^
+         ((guint) (self->sy * 16) << 8);
+}
+
+static gboolean
+gsk_gpu_cached_node_equal (gconstpointer v1,
+                           gconstpointer v2)
+{
+  const GskGpuCachedNode *node1 = v1;
+  const GskGpuCachedNode *node2 = v2;
+
+  return node1->node == node2->node &&
+         node1->sx == node2->sx &&
+         node1->sy == node2->sy &&
+         gsk_rect_equal (&node1->bounds, &node2->bounds) &&
+         gdk_color_state_equal (node1->ccs, node2->ccs);
+}
+
+static const GskGpuCachedClass GSK_GPU_CACHED_NODE_CLASS =
+{
+  sizeof (GskGpuCachedNode),
+  "Node",
+  gsk_gpu_cached_node_free,
+  gsk_gpu_cached_node_should_collect
+};
+
+static void
+gsk_gpu_cached_node_prune_candidates (GskGpuCachePrivate *priv,
+                                      gint64              timestamp)
+{
+  GHashTableIter iter;
+  Candidate *candidate;
+
+  if (priv->node_candidates_timestamp == timestamp)
+    return;
+
+  g_hash_table_iter_init (&iter, priv->node_candidates);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &candidate))
+    {
+      if (timestamp - candidate->timestamp > CANDIDATE_TIMEOUT)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  priv->node_candidates_timestamp = timestamp;
+}
+
+/*
+ * gsk_gpu_cached_node_lookup:
+ * @self: the cache
+ * @frame: the frame that is being recorded
+ * @node: the node to look up
+ * @ccs: the compositing color state
+ * @scale: the scale the node is drawn at
+ * @bounds: the area of the node that is drawn, aligned to the pixel grid
+ * @out_retain: (out): set to %TRUE if @node was drawn unchanged in an
+ *   earlier frame and should be added with gsk_gpu_cached_node_add()
+ *
+ * Looks up a retained image of @node.
+ *
+ * Returns: (nullable) (transfer full): the retained image of @node
+ *   covering exactly @bounds
+ **/
+GskGpuImage *
+gsk_gpu_cached_node_lookup (GskGpuCache           *self,
+                            GskGpuFrame           *frame,
+                            GskRenderNode         *node,
+                            GdkColorState         *ccs,
+                            const graphene_vec2_t *scale,
+                            const graphene_rect_t *bounds,
+                            gboolean              *out_retain)
+{
+  GskGpuCachePrivate *priv = gsk_gpu_cache_get_private (self);
+  float sx = graphene_vec2_get_x (scale);
+  float sy = graphene_vec2_get_y (scale);
+  gint64 timestamp = gsk_gpu_frame_get_timestamp (frame);
+  GskGpuCachedNode *cache;
+  Candidate *candidate;
+
+  *out_retain = FALSE;
+
+  cache = g_hash_table_lookup (priv->node_cache,
+                               &(GskGpuCachedNode) {
+                                 .node = node,
+                                 .ccs = ccs,
+                                 .sx = sx,
+                                 .sy = sy,
+                                 .bounds = *bounds,
+                               });
+  if (cache)
+    {
+      gsk_gpu_cached_use ((GskGpuCached *) cache);
+      priv->node_cache_hits++;
+
+      return g_object_ref (cache->image);
+    }
+
+  gsk_gpu_cached_node_prune_candidates (priv, timestamp);
+
+  candidate = g_hash_table_lookup (priv->node_candidates, node);
+  if (candidate == NULL)
+    {
+      candidate = g_new (Candidate, 1);
+      g_hash_table_insert (priv->node_candidates, node, candidate);
+    }
+  else if (candidate->timestamp != timestamp &&
+           candidate->sx == sx &&
+           candidate->sy == sy &&
+           gsk_rect_equal (&candidate->bounds, bounds) &&
+           priv->node_cache_pixels + sx * bounds->size.width * sy * bounds->size.height <= MAX_RETAINED_PIXELS)
+    {
+      *out_retain = TRUE;
+    }
+
+  candidate->timestamp = timestamp;
+  candidate->sx = sx;
+  candidate->sy = sy;
+  candidate->bounds = *bounds;
+
+  return NULL;
+}
+
+void
+gsk_gpu_cached_node_add (GskGpuCache           *self,
+                         GskRenderNode         *node,
+                         GdkColorState         *ccs,
+                         const graphene_vec2_t *scale,
+                         const graphene_rect_t *bounds,
+                         GskGpuImage           *image)
+{
+  GskGpuCachePrivate *priv = gsk_gpu_cache_get_private (self);
+  GskGpuCachedNode *cache;
+
+  cache = gsk_gpu_cached_new (self, &GSK_GPU_CACHED_NODE_CLASS);
+  cache->node = gsk_render_node_ref (node);
+  cache->ccs = gdk_color_state_ref (ccs);
+  cache->sx = graphene_vec2_get_x (scale);
+  cache->sy = graphene_vec2_get_y (scale);
+  cache->bounds = *bounds;
+  cache->image = g_object_ref (image);
+  ((GskGpuCached *) cache)->pixels = gsk_gpu_image_get_width (image) * gsk_gpu_image_get_height (image);
+
+  priv->node_cache_pixels += ((GskGpuCached *) cache)->pixels;
+  priv->node_cache_misses++;
+
+  g_hash_table_remove (priv->node_candidates, node);
+  g_hash_table_insert (priv->node_cache, cache, cache);
+  gsk_gpu_cached_use ((GskGpuCached *) cache);
+}
+
+void
+gsk_gpu_cached_node_init_cache (GskGpuCache *cache)
+{
+  GskGpuCachePrivate *priv = gsk_gpu_cache_get_private (cache);
+
+  priv->node_cache = g_hash_table_new (gsk_gpu_cached_node_hash,
+                                       gsk_gpu_cached_node_equal);
+  priv->node_candidates = g_hash_table_new_full (g_direct_hash,
+                                                 g_direct_equal,
+                                                 NULL,
+                                                 g_free);
+}
+
+void
+gsk_gpu_cached_node_finish_cache (GskGpuCache *cache)
+{
+  GskGpuCachePrivate *priv = gsk_gpu_cache_get_private (cache);
+
+  g_hash_table_unref (priv->node_cache);
+  g_hash_table_unref (priv->node_candidates);
+}
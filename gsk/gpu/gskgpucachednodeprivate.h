@@ -0,0 +1,28 @@
+#pragma once
+
+#include "gskgpucachedprivate.h"
+
+#include "gsk/gskrendernode.h"
+
+#include <graphene.h>
+
+G_BEGIN_DECLS
+
+void                    gsk_gpu_cached_node_init_cache                  (GskGpuCache            *cache);
+void                    gsk_gpu_cached_node_finish_cache                (GskGpuCache            *cache);
+
+GskGpuImage *           gsk_gpu_cached_node_lookup                      (GskGpuCache            *self,
+                                                                         GskGpuFrame            *frame,
+                                                                         GskRenderNode          *node,
+                                                                         GdkColorState          *ccs,
+                                                                         const graphene_vec2_t  *scale,
+                                                                         const graphene_rect_t  *bounds,
+                                                                         gboolean               *out_retain);
+void                    gsk_gpu_cached_node_add                         (GskGpuCache            *self,
+                                                                         GskRenderNode          *node,
+                                                                         GdkColorState          *ccs,
+                                                                         const graphene_vec2_t  *scale,
+                                                                         const graphene_rect_t  *bounds,
+                                                                         GskGpuImage            *image);
+
+G_END_DECLS
@@ -38,6 +38,14 @@ struct _GskGpuCachePrivate
   GHashTable *glyph_cache;
   GHashTable *fill_cache;
   GHashTable *stroke_cache;
+  GHashTable *node_cache;
+
+  /* retained nodes */
+  GHashTable *node_candidates;
+  gint64 node_candidates_timestamp;
+  gsize node_cache_pixels;
+  guint node_cache_hits;
+  guint node_cache_misses;
 
   /* Vulkan-specific */
   GHashTable *ycbcr_cache;
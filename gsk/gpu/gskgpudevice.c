@@ -27,6 +27,21 @@ struct _GskGpuDevicePrivate
 
 G_DEFINE_TYPE_WITH_PRIVATE (GskGpuDevice, gsk_gpu_device, G_TYPE_OBJECT)
 
+static void
+gsk_gpu_device_print_memory_stats (GskGpuDevice *self)
+{
+  GskGpuDeviceClass *klass = GSK_GPU_DEVICE_GET_CLASS (self);
+  GString *string;
+
+  if (klass->print_memory_stats == NULL)
+    return;
+
+  string = g_string_new ("GPU memory");
+  klass->print_memory_stats (self, string);
+  gdk_debug_message ("%s", string->str);
+  g_string_free (string, TRUE);
+}
+
 /* Returns TRUE if everything was GC'ed */
 static gboolean
 gsk_gpu_device_gc (GskGpuDevice *self,
@@ -46,6 +61,9 @@ gsk_gpu_device_gc (GskGpuDevice *self,
   if (result)
     g_clear_object (&priv->cache);
 
+  if (GSK_DEBUG_CHECK (MEMORY))
+    gsk_gpu_device_print_memory_stats (self);
+
   return result;
 }
 
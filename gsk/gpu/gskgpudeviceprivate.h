@@ -44,6 +44,8 @@ struct _GskGpuDeviceClass
                                                                          gsize                   width,
                                                                          gsize                   height);
   void                  (* make_current)                                (GskGpuDevice           *self);
+  void                  (* print_memory_stats)                          (GskGpuDevice           *self,
+                                                                         GString                *string);
 
 };
 
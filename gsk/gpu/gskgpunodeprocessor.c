@@ -11,6 +11,7 @@
 #include "gskgpucacheprivate.h"
 #include "gskgpucachedglyphprivate.h"
 #include "gskgpucachedfillprivate.h"
+#include "gskgpucachednodeprivate.h"
 #include "gskgpucachedstrokeprivate.h"
 #include "gskgpuclearopprivate.h"
 #include "gskgpuclipprivate.h"
@@ -93,6 +94,20 @@
  */
 #define MIN_PERCENTAGE_FOR_OCCLUSION_PASS 10
 
+/* Large blurs are done at reduced resolution, as long as the
+ * blur still uses at least this many samples per side.
+ * We only ever halve the resolution: Each reduced pixel samples the
+ * source once, and a linear filter at the center of a 2x2 block
+ * averages all of it. With larger factors, pixels would be skipped.
+ */
+#define MIN_BLUR_SAMPLES_FOR_DOWNSCALE 16
+#define MAX_BLUR_DOWNSCALE 2
+
+/* the amount of pixels a container needs to cover for it to be
+ * worth keeping in an offscreen when it doesn't change
+ */
+#define MIN_PIXELS_FOR_RETAINING (256 * 256)
+
 /* A note about coordinate systems
  *
  * The rendering code keeps track of multiple coordinate systems to optimize rendering as
@@ -899,6 +914,169 @@ gsk_gpu_node_processor_get_node_as_image (GskGpuNodeProcessor   *self,
                                     out_bounds);
 }
 
+static guint
+gsk_gpu_node_processor_get_blur_downscale (GskGpuNodeProcessor *self,
+                                           float                blur_radius)
+{
+  float samples;
+  guint downscale;
+
+  if (!gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_BLUR_DOWNSCALE))
+    return 1;
+
+  /* see gskgpublur.glsl for how the samples are computed */
+  samples = blur_radius * MIN (graphene_vec2_get_x (&self->scale), graphene_vec2_get_y (&self->scale));
+
+  for (downscale = 1; downscale < MAX_BLUR_DOWNSCALE; downscale *= 2)
+    {
+      if (samples / (2 * downscale) < MIN_BLUR_SAMPLES_FOR_DOWNSCALE)
+        break;
+    }
+
+  return downscale;
+}
+
+/* Does both passes of the blur into offscreens at a reduced scale
+ * and then scales the result up. A Gaussian with a large radius
+ * removes all the high frequencies that get lost by downscaling,
+ * so the difference to the full resolution result is tiny.
+ */
+static void
+gsk_gpu_node_processor_downscaled_blur_op (GskGpuNodeProcessor       *self,
+                                           const graphene_rect_t     *rect,
+                                           const graphene_point_t    *shadow_offset,
+                                           float                      blur_radius,
+                                           const GdkColor            *shadow_color,
+                                           GskGpuImage               *source_image,
+                                           GdkMemoryDepth             source_depth,
+                                           const graphene_rect_t     *source_rect,
+                                           guint                      downscale)
+{
+  GskGpuNodeProcessor other;
+  GskGpuImage *horizontal, *vertical;
+  graphene_vec2_t scale, direction;
+  graphene_rect_t clip_rect, horizontal_rect, vertical_rect, draw_rect;
+  graphene_point_t real_offset;
+  float clip_radius;
+
+  graphene_vec2_init (&scale,
+                      graphene_vec2_get_x (&self->scale) / downscale,
+                      graphene_vec2_get_y (&self->scale) / downscale);
+
+  clip_radius = gsk_cairo_blur_compute_pixels (blur_radius / 2.0);
+
+  gsk_gpu_node_processor_get_clip_bounds (self, &clip_rect);
+  clip_rect.origin.x -= shadow_offset->x;
+  clip_rect.origin.y -= shadow_offset->y;
+
+  /* the area of the result */
+  if (!gsk_rect_intersection (rect, &clip_rect, &vertical_rect) ||
+      !gsk_rect_snap_to_grid (&vertical_rect, &scale, &self->offset, &vertical_rect))
+    return;
+
+  /* the area the vertical pass reads from */
+  graphene_rect_inset_r (&vertical_rect, 0.f, -clip_radius, &horizontal_rect);
+  if (!gsk_rect_intersection (rect, &horizontal_rect, &horizontal_rect) ||
+      !gsk_rect_snap_to_grid (&horizontal_rect, &scale, &self->offset, &horizontal_rect))
+    return;
+
+  horizontal = gsk_gpu_node_processor_init_draw (&other,
+                                                 self->frame,
+                                                 self->ccs,
+                                                 source_depth,
+                                                 &scale,
+                                                 &horizontal_rect);
+  g_return_if_fail (horizontal != NULL);
+
+  gsk_gpu_node_processor_sync_globals (&other, 0);
+
+  graphene_vec2_init (&direction, blur_radius, 0.0f);
+  gsk_gpu_blur_op (other.frame,
+                   gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &horizontal_rect),
+                   other.ccs,
+                   1,
+                   &other.offset,
+                   &(GskGpuShaderImage) {
+                       source_image,
+                       GSK_GPU_SAMPLER_TRANSPARENT,
+                       &horizontal_rect,
+                       source_rect
+                   },
+                   &direction);
+
+  gsk_gpu_node_processor_finish_draw (&other, horizontal);
+
+  vertical = gsk_gpu_node_processor_init_draw (&other,
+                                               self->frame,
+                                               self->ccs,
+                                               source_depth,
+                                               &scale,
+                                               &vertical_rect);
+  if (vertical == NULL)
+    {
+      g_object_unref (horizontal);
+      g_return_if_reached ();
+    }
+
+  gsk_gpu_node_processor_sync_globals (&other, 0);
+
+  graphene_vec2_init (&direction, 0.0f, blur_radius);
+  gsk_gpu_blur_op (other.frame,
+                   gsk_gpu_clip_get_shader_clip (&other.clip, &other.offset, &vertical_rect),
+                   other.ccs,
+                   1,
+                   &other.offset,
+                   &(GskGpuShaderImage) {
+                       horizontal,
+                       GSK_GPU_SAMPLER_TRANSPARENT,
+                       &vertical_rect,
+                       &horizontal_rect
+                   },
+                   &direction);
+
+  gsk_gpu_node_processor_finish_draw (&other, vertical);
+
+  g_object_unref (horizontal);
+
+  if (!gsk_rect_intersection (rect, &vertical_rect, &draw_rect))
+    {
+      g_object_unref (vertical);
+      return;
+    }
+
+  real_offset = GRAPHENE_POINT_INIT (self->offset.x + shadow_offset->x,
+                                     self->offset.y + shadow_offset->y);
+  if (shadow_color)
+    {
+      gsk_gpu_colorize_op (self->frame,
+                           gsk_gpu_clip_get_shader_clip (&self->clip, &real_offset, &draw_rect),
+                           self->ccs,
+                           1,
+                           &real_offset,
+                           &(GskGpuShaderImage) {
+                               vertical,
+                               GSK_GPU_SAMPLER_DEFAULT,
+                               &draw_rect,
+                               &vertical_rect,
+                           },
+                           shadow_color);
+    }
+  else
+    {
+      gsk_gpu_texture_op (self->frame,
+                          gsk_gpu_clip_get_shader_clip (&self->clip, &real_offset, &draw_rect),
+                          &real_offset,
+                          &(GskGpuShaderImage) {
+                              vertical,
+                              GSK_GPU_SAMPLER_DEFAULT,
+                              &draw_rect,
+                              &vertical_rect,
+                          });
+    }
+
+  g_object_unref (vertical);
+}
+
 static void
 gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
                                 const graphene_rect_t     *rect,
@@ -915,6 +1093,22 @@ gsk_gpu_node_processor_blur_op (GskGpuNodeProcessor       *self,
   graphene_rect_t clip_rect, intermediate_rect;
   graphene_point_t real_offset;
   float clip_radius;
+  guint downscale;
+
+  downscale = gsk_gpu_node_processor_get_blur_downscale (self, blur_radius);
+  if (downscale > 1)
+    {
+      gsk_gpu_node_processor_downscaled_blur_op (self,
+                                                 rect,
+                                                 shadow_offset,
+                                                 blur_radius,
+                                                 shadow_color,
+                                                 source_image,
+                                                 source_depth,
+                                                 source_rect,
+                                                 downscale);
+      return;
+    }
 
   clip_radius = gsk_cairo_blur_compute_pixels (blur_radius / 2.0);
 
@@ -4545,6 +4739,65 @@ static const struct
   },
 };
 
+static gboolean
+gsk_gpu_node_processor_add_retained_node (GskGpuNodeProcessor *self,
+                                          GskRenderNode       *node)
+{
+  GskGpuCache *cache;
+  GskGpuImage *image;
+  graphene_rect_t bounds;
+  gboolean retain;
+
+  if (gsk_render_node_get_node_type (node) != GSK_CONTAINER_NODE ||
+      gsk_container_node_get_n_children (node) < 2)
+    return FALSE;
+
+  /* only handle the case where the node maps to pixels 1:1 */
+  if (self->modelview != NULL)
+    return FALSE;
+
+  /* subsurfaces depend on the offload state, which can change
+   * without the node changing */
+  if (gsk_render_node_contains_subsurface_node (node))
+    return FALSE;
+
+  if (!gsk_rect_snap_to_grid (&node->bounds, &self->scale, &self->offset, &bounds) ||
+      graphene_vec2_get_x (&self->scale) * bounds.size.width *
+      graphene_vec2_get_y (&self->scale) * bounds.size.height < MIN_PIXELS_FOR_RETAINING)
+    return FALSE;
+
+  cache = gsk_gpu_device_get_cache (gsk_gpu_frame_get_device (self->frame));
+  image = gsk_gpu_cached_node_lookup (cache, self->frame, node, self->ccs, &self->scale, &bounds, &retain);
+  if (image == NULL)
+    {
+      if (!retain)
+        return FALSE;
+
+      image = gsk_gpu_node_processor_create_offscreen (self->frame,
+                                                       self->ccs,
+                                                       &self->scale,
+                                                       &bounds,
+                                                       node);
+      if (image == NULL)
+        return FALSE;
+
+      gsk_gpu_cached_node_add (cache, node, self->ccs, &self->scale, &bounds, image);
+    }
+
+  gsk_gpu_node_processor_sync_globals (self, 0);
+
+  gsk_gpu_node_processor_image_op (self,
+                                   image,
+                                   self->ccs,
+                                   GSK_GPU_SAMPLER_DEFAULT,
+                                   &node->bounds,
+                                   &bounds);
+
+  g_object_unref (image);
+
+  return TRUE;
+}
+
 static void
 gsk_gpu_node_processor_add_node (GskGpuNodeProcessor *self,
                                  GskRenderNode       *node)
@@ -4567,6 +4820,10 @@ gsk_gpu_node_processor_add_node (GskGpuNodeProcessor *self,
       return;
     }
 
+  if (gsk_gpu_frame_should_optimize (self->frame, GSK_GPU_OPTIMIZE_RETAIN) &&
+      gsk_gpu_node_processor_add_retained_node (self, node))
+    return;
+
   if (self->opacity < 1.0 && (nodes_vtable[node_type].features & GSK_GPU_HANDLE_OPACITY) == 0)
     {
       gsk_gpu_node_processor_add_without_opacity (self, node);
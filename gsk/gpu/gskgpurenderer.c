@@ -33,6 +33,11 @@ static const GdkDebugKey gsk_gpu_optimization_keys[] = {
   { "to-image",  GSK_GPU_OPTIMIZE_TO_IMAGE,          "Don't fast-path creation of images for nodes" },
   { "occlusion", GSK_GPU_OPTIMIZE_OCCLUSION_CULLING, "Disable occlusion culling via opaque node tracking" },
   { "repeat",    GSK_GPU_OPTIMIZE_REPEAT,            "Repeat drawing operations instead of using offscreen and GL_REPEAT" },
+  { "blur",      GSK_GPU_OPTIMIZE_BLUR_DOWNSCALE,    "Always blur at full resolution" },
+};
+
+static const GdkDebugKey gsk_gpu_opt_in_optimization_keys[] = {
+  { "retain",    GSK_GPU_OPTIMIZE_RETAIN,            "Keep unchanged subtrees in offscreens across frames" },
 };
 
 typedef struct _GskGpuRendererPrivate GskGpuRendererPrivate;
@@ -496,7 +501,12 @@ gsk_gpu_renderer_class_init (GskGpuRendererClass *klass)
 
   gsk_ensure_resources ();
 
-  klass->optimizations = -1;
+  klass->optimizations = ~GSK_GPU_OPTIMIZE_RETAIN;
+  klass->optimizations |= gdk_parse_debug_var ("GSK_GPU_ENABLE",
+      "GSK_GPU_ENABLE can be set to a list of values which cause GSK to enable\n"
+      "experimental optimizations in the \'ngl\' and \'vulkan\' renderers.\n",
+      gsk_gpu_opt_in_optimization_keys,
+      G_N_ELEMENTS (gsk_gpu_opt_in_optimization_keys));
   klass->optimizations &= ~gdk_parse_debug_var ("GSK_GPU_DISABLE",
       "GSK_GPU_DISABLE can be set to of values which cause GSK to disable\n"
       "certain optimizations in the \'ngl\' and \'vulkan\' renderers.\n",
@@ -159,5 +159,8 @@ typedef enum {
   GSK_GPU_OPTIMIZE_OCCLUSION_CULLING    = 1 <<  6,
   GSK_GPU_OPTIMIZE_REPEAT               = 1 <<  7,
   GSK_GPU_OPTIMIZE_DUAL_BLEND           = 1 <<  8,
+  GSK_GPU_OPTIMIZE_BLUR_DOWNSCALE       = 1 <<  9,
+  /* opt-in */
+  GSK_GPU_OPTIMIZE_RETAIN               = 1 << 10,
 } GskGpuOptimizations;
 
@@ -16,34 +16,38 @@
 #include "gdk/gdkcolorstateprivate.h"
 #include "gdk/gdkdmabuftextureprivate.h"
 #include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gsk/gskdebugprivate.h"
 
-static GskGpuOp *
-gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
-                                        GskGpuFrame                 *frame,
-                                        GskGpuImage                 *image,
-                                        const cairo_rectangle_int_t *area,
-                                        void           (* draw_func) (GskGpuOp *, guchar *, const GdkMemoryLayout *))
+static guint profiler_texture_uploads_id;
+static gint64 profiler_texture_uploads;
+
+static void
+gsk_gpu_upload_op_count_bytes (gsize size)
 {
-  GskGLImage *gl_image = GSK_GL_IMAGE (image);
-  GdkMemoryLayout layout;
-  guchar *data, *pdata;
-  guint i, p, gl_format, gl_type, stride, tex_id;
-  gsize width_subsample, height_subsample, bpp;
+  if (G_UNLIKELY (profiler_texture_uploads_id == 0))
+    profiler_texture_uploads_id = gdk_profiler_define_int_counter ("texture-uploads",
+                                                                   "Number of bytes of texture data uploaded to GPU");
 
-  gdk_memory_layout_init (&layout,
-                          gsk_gpu_image_get_format (GSK_GPU_IMAGE (image)),
-                          area->width,
-                          area->height,
-                          4);
-  data = g_malloc (layout.size);
+  profiler_texture_uploads += size;
+  gdk_profiler_set_int_counter (profiler_texture_uploads_id, profiler_texture_uploads);
+}
 
-  draw_func (op, data, &layout);
+static void
+gsk_gpu_upload_op_gl_upload (GskGLImage                  *gl_image,
+                             const cairo_rectangle_int_t *area,
+                             const guchar                *data,
+                             const GdkMemoryLayout       *layout)
+{
+  const guchar *pdata;
+  guint i, p, gl_format, gl_type, stride, tex_id;
+  gsize width_subsample, height_subsample, bpp;
 
   glActiveTexture (GL_TEXTURE0);
   
-  glPixelStorei (GL_UNPACK_ALIGNMENT, gdk_memory_format_alignment (layout.format));
+  glPixelStorei (GL_UNPACK_ALIGNMENT, gdk_memory_format_alignment (layout->format));
 
   for (i = 0; i < 3; i++)
     {
@@ -53,7 +57,7 @@ gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
 
       glBindTexture (GL_TEXTURE_2D, tex_id);
 
-      p = gdk_memory_format_get_shader_plane (layout.format,
+      p = gdk_memory_format_get_shader_plane (layout->format,
                                               i,
                                               &width_subsample,
                                               &height_subsample,
@@ -61,8 +65,8 @@ gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
 
       gl_format = gsk_gl_image_get_gl_format (gl_image, i);
       gl_type = gsk_gl_image_get_gl_type (gl_image, i);
-      stride = layout.planes[p].stride;
-      pdata = data + gdk_memory_layout_offset (&layout, p, 0, 0);
+      stride = layout->planes[p].stride;
+      pdata = data + gdk_memory_layout_offset (layout, p, 0, 0);
 
       if (stride == area->width * bpp / width_subsample)
         {
@@ -101,6 +105,30 @@ gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
 
   glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
 
+  gsk_gpu_upload_op_count_bytes (layout->size);
+}
+
+static GskGpuOp *
+gsk_gpu_upload_op_gl_command_with_area (GskGpuOp                    *op,
+                                        GskGpuFrame                 *frame,
+                                        GskGpuImage                 *image,
+                                        const cairo_rectangle_int_t *area,
+                                        void           (* draw_func) (GskGpuOp *, guchar *, const GdkMemoryLayout *))
+{
+  GdkMemoryLayout layout;
+  guchar *data;
+
+  gdk_memory_layout_init (&layout,
+                          gsk_gpu_image_get_format (GSK_GPU_IMAGE (image)),
+                          area->width,
+                          area->height,
+                          4);
+  data = g_malloc (layout.size);
+
+  draw_func (op, data, &layout);
+
+  gsk_gpu_upload_op_gl_upload (GSK_GL_IMAGE (image), area, data, &layout);
+
   g_free (data);
 
   return op->next;
@@ -300,6 +328,7 @@ gsk_gpu_upload_texture_op_draw (GskGpuOp              *op,
                                 const GdkMemoryLayout *layout)
 {
   GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
+  G_GNUC_UNUSED gint64 begin_time = GDK_PROFILER_CURRENT_TIME;
 
   if (self->lod_level == 0)
     {
@@ -319,6 +348,13 @@ gsk_gpu_upload_texture_op_draw (GskGpuOp              *op,
                          self->lod_filter == GSK_SCALING_FILTER_TRILINEAR ? TRUE : FALSE);
       g_bytes_unref (bytes);
     }
+
+  gdk_profiler_end_markf (begin_time,
+                          "Prepare texture upload",
+                          "%s %" G_GSIZE_FORMAT "x%" G_GSIZE_FORMAT " lod=%u",
+                          G_OBJECT_TYPE_NAME (self->texture),
+                          layout->width, layout->height,
+                          self->lod_level);
 }
 
 #ifdef GDK_RENDERING_VULKAN
@@ -345,6 +381,27 @@ gsk_gpu_upload_texture_op_gl_command (GskGpuOp          *op,
 {
   GskGpuUploadTextureOp *self = (GskGpuUploadTextureOp *) op;
 
+  /* If the texture already is in the right format, GL can read it
+   * directly, no need to copy it into a temporary buffer first.
+   */
+  if (self->lod_level == 0 &&
+      GDK_IS_MEMORY_TEXTURE (self->texture) &&
+      gdk_texture_get_format (self->texture) == gsk_gpu_image_get_format (self->image))
+    {
+      GdkMemoryTexture *memtex = GDK_MEMORY_TEXTURE (self->texture);
+
+      gsk_gpu_upload_op_gl_upload (GSK_GL_IMAGE (self->image),
+                                   &(cairo_rectangle_int_t) {
+                                       0, 0,
+                                       gsk_gpu_image_get_width (self->image),
+                                       gsk_gpu_image_get_height (self->image)
+                                   },
+                                   g_bytes_get_data (gdk_memory_texture_get_bytes (memtex), NULL),
+                                   gdk_memory_texture_get_layout (memtex));
+
+      return op->next;
+    }
+
   return gsk_gpu_upload_op_gl_command (op,
                                        frame,
                                        self->image,
@@ -342,6 +342,23 @@ gsk_vulkan_device_finalize (GObject *object)
   G_OBJECT_CLASS (gsk_vulkan_device_parent_class)->finalize (object);
 }
 
+static void
+gsk_vulkan_device_print_memory_stats (GskGpuDevice *device,
+                                      GString      *string)
+{
+  GskVulkanDevice *self = GSK_VULKAN_DEVICE (device);
+  gsize i;
+
+  for (i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+    {
+      if (self->allocators[i] == NULL)
+        continue;
+
+      g_string_append_printf (string, "\n  Memory type %" G_GSIZE_FORMAT ": ", i);
+      gsk_vulkan_allocator_print_stats (self->allocators[i], string);
+    }
+}
+
 static void
 gsk_vulkan_device_class_init (GskVulkanDeviceClass *klass)
 {
@@ -353,6 +370,7 @@ gsk_vulkan_device_class_init (GskVulkanDeviceClass *klass)
   gpu_device_class->create_upload_image = gsk_vulkan_device_create_upload_image;
   gpu_device_class->create_download_image = gsk_vulkan_device_create_download_image;
   gpu_device_class->make_current = gsk_vulkan_device_make_current;
+  gpu_device_class->print_memory_stats = gsk_vulkan_device_print_memory_stats;
 
   object_class->finalize = gsk_vulkan_device_finalize;
 }
@@ -118,6 +118,12 @@ struct _GskVulkanBuddyAllocator
 
   GskVulkanAllocation cache;
   GskVulkanAllocationList free_lists[N_SUBDIVISIONS];
+
+  /* stats */
+  gsize n_blocks;
+  gsize n_bytes_used;
+  gsize n_dedicated;
+  gsize n_bytes_dedicated;
 };
 
 static void
@@ -164,6 +170,8 @@ gsk_vulkan_buddy_allocator_alloc (GskVulkanAllocator  *allocator,
   if (slot >= self->block_size_slot)
     {
       gsk_vulkan_alloc (self->allocator, size, align, alloc);
+      self->n_dedicated++;
+      self->n_bytes_dedicated += alloc->size;
       return;
     }
 
@@ -186,6 +194,7 @@ gsk_vulkan_buddy_allocator_alloc (GskVulkanAllocator  *allocator,
            * to find the buddy allocation.
            */
           gsk_vulkan_alloc (self->allocator, 1 << self->block_size_slot, 1 << self->block_size_slot, alloc);
+          self->n_blocks++;
         }
     }
   else
@@ -206,6 +215,8 @@ gsk_vulkan_buddy_allocator_alloc (GskVulkanAllocator  *allocator,
     }
 
   g_assert (alloc->size >= size);
+
+  self->n_bytes_used += alloc->size;
 }
 
 static void
@@ -218,10 +229,14 @@ gsk_vulkan_buddy_allocator_free (GskVulkanAllocator  *allocator,
   slot = find_slot (alloc->size);
   if (slot >= self->block_size_slot)
     {
+      self->n_dedicated--;
+      self->n_bytes_dedicated -= alloc->size;
       gsk_vulkan_free (self->allocator, alloc);
       return;
     }
 
+  self->n_bytes_used -= alloc->size;
+
   slot = MIN (self->block_size_slot - slot, N_SUBDIVISIONS) - 1;
 restart:
   n = gsk_vulkan_allocation_list_get_size (&self->free_lists[slot]);
@@ -241,9 +256,14 @@ restart:
           if (slot == 0)
             {
               if (self->cache.vk_memory == VK_NULL_HANDLE)
-                self->cache = *alloc;
+                {
+                  self->cache = *alloc;
+                }
               else
-                gsk_vulkan_free (self->allocator, alloc);
+                {
+                  gsk_vulkan_free (self->allocator, alloc);
+                  self->n_blocks--;
+                }
               return;
             }
           else
@@ -257,6 +277,33 @@ restart:
   gsk_vulkan_allocation_list_append (&self->free_lists[slot], alloc);
 }
 
+static void
+gsk_vulkan_buddy_allocator_print_stats (GskVulkanAllocator *allocator,
+                                        GString            *string)
+{
+  GskVulkanBuddyAllocator *self = (GskVulkanBuddyAllocator *) allocator;
+  gsize block_size, n_bytes_free, n_bytes_spare;
+
+  block_size = (gsize) 1 << self->block_size_slot;
+  n_bytes_free = self->n_blocks * block_size - self->n_bytes_used;
+  n_bytes_spare = self->cache.vk_memory ? block_size : 0;
+
+  /* Free memory in blocks that still contain allocations can
+   * only be reused for allocations of the same or smaller size,
+   * and the blocks can't be returned, so count it as fragmented.
+   */
+  g_string_append_printf (string,
+                          "%" G_GSIZE_FORMAT " blocks: %" G_GSIZE_FORMAT " bytes live, "
+                          "%" G_GSIZE_FORMAT " bytes free, %" G_GSIZE_FORMAT " bytes fragmented; "
+                          "%" G_GSIZE_FORMAT " dedicated: %" G_GSIZE_FORMAT " bytes",
+                          self->n_blocks,
+                          self->n_bytes_used,
+                          n_bytes_free,
+                          n_bytes_free - n_bytes_spare,
+                          self->n_dedicated,
+                          self->n_bytes_dedicated);
+}
+
 GskVulkanAllocator *
 gsk_vulkan_buddy_allocator_new (GskVulkanAllocator *allocator,
                                 gsize               block_size)
@@ -269,6 +316,7 @@ gsk_vulkan_buddy_allocator_new (GskVulkanAllocator *allocator,
   self->allocator_class.free_allocator = gsk_vulkan_buddy_allocator_free_allocator;
   self->allocator_class.alloc = gsk_vulkan_buddy_allocator_alloc;
   self->allocator_class.free = gsk_vulkan_buddy_allocator_free;
+  self->allocator_class.print_stats = gsk_vulkan_buddy_allocator_print_stats;
   self->allocator = allocator;
   self->block_size_slot = find_slot (block_size);
 
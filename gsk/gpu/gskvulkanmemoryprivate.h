@@ -34,6 +34,9 @@ struct _GskVulkanAllocator
                                                                          GskVulkanAllocation            *out_alloc);
   void                  (* free)                                        (GskVulkanAllocator             *allocator,
                                                                          GskVulkanAllocation            *alloc);
+  /* optional */
+  void                  (* print_stats)                                 (GskVulkanAllocator             *allocator,
+                                                                         GString                        *string);
 };
 
 static inline void      gsk_vulkan_alloc                                (GskVulkanAllocator             *allocator,
@@ -42,6 +45,8 @@ static inline void      gsk_vulkan_alloc                                (GskVulk
                                                                          GskVulkanAllocation            *out_alloc);
 static inline void      gsk_vulkan_free                                 (GskVulkanAllocator             *allocator,
                                                                          GskVulkanAllocation            *alloc);
+static inline void      gsk_vulkan_allocator_print_stats                (GskVulkanAllocator             *allocator,
+                                                                         GString                        *string);
 
 static inline GskVulkanAllocator *
                         gsk_vulkan_allocator_ref                        (GskVulkanAllocator             *self);
@@ -71,6 +76,16 @@ gsk_vulkan_free (GskVulkanAllocator  *allocator,
   allocator->free (allocator, alloc);
 }
 
+static inline void
+gsk_vulkan_allocator_print_stats (GskVulkanAllocator *allocator,
+                                  GString            *string)
+{
+  if (allocator->print_stats)
+    allocator->print_stats (allocator, string);
+  else
+    g_string_append (string, "no stats");
+}
+
 static inline GskVulkanAllocator *
 gsk_vulkan_allocator_ref (GskVulkanAllocator *self)
 {
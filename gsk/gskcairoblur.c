@@ -24,8 +24,7 @@
 
 #include "gskcairoblurprivate.h"
 #include "gdkcairoprivate.h"
-
-#include "gdkcairoprivate.h"
+#include "gdkparalleltaskprivate.h"
 
 #include <math.h>
 #include <string.h>
@@ -56,6 +55,17 @@
 #define BOX_FILTER_SIZE_9 16
 #define BOX_FILTER_SIZE_10 18
 
+/* Divisors up to this size are done via multiplication with their
+ * reciprocal. The sums we divide are always less than 256 * d, so
+ * with a 32bit reciprocal the result is exact as long as
+ * 256 * d * d <= 2^32.
+ */
+#define MAX_RECIPROCAL_DIVISOR 4096
+
+#define get_reciprocal(d) ((G_GUINT64_CONSTANT (1) << 32) / (d) + 1)
+#define DIVIDE(n, D) ((n) / (D))
+#define DIVIDE_RECIPROCAL(n, D) ((guint) (((guint64) (n) * reciprocal) >> 32))
+
 /* This applies a single box blur pass to a horizontal range of pixels;
  * since the box blur has the same weight for all pixels, we can
  * implement an efficient sliding window algorithm where we add
@@ -73,6 +83,7 @@ blur_xspan (guchar *row,
             int     d,
             int     shift)
 {
+  guint64 reciprocal;
   int offset;
   int sum = 0;
   int i;
@@ -85,14 +96,13 @@ blur_xspan (guchar *row,
   /* All the conditionals in here look slow, but the branches will
    * be well predicted and there are enough different possibilities
    * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
+   * is hard and not an obvious win. The integer division per pixel
+   * is avoided by unrolling small filter sizes, so the compiler can
+   * optimize the division by a constant, and by multiplying with
+   * the reciprocal for larger ones.
    */
 
-#define BLUR_ROW_KERNEL(D)                                      \
+#define BLUR_ROW_KERNEL(D, DIVIDE_FUNC)                         \
   for (i = -(D) + offset; i < row_width + offset; i++)		\
     {                                                           \
       if (i >= 0 && i < row_width)                              \
@@ -103,7 +113,7 @@ blur_xspan (guchar *row,
 	  if (i >= (D))						\
 	    sum -= row[i - (D)];				\
                                                                 \
-	  tmp_buffer[i - offset] = (sum + (D) / 2) / (D);	\
+	  tmp_buffer[i - offset] = DIVIDE_FUNC (sum + (D) / 2, D); \
 	}							\
     }								\
   break;
@@ -112,82 +122,197 @@ blur_xspan (guchar *row,
    * divide operation (not radius 1, because its a no-op) */
   switch (d)
     {
-    case BOX_FILTER_SIZE_2: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_2);
-    case BOX_FILTER_SIZE_3: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_3);
-    case BOX_FILTER_SIZE_4: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_4);
-    case BOX_FILTER_SIZE_5: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_5);
-    case BOX_FILTER_SIZE_6: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_6);
-    case BOX_FILTER_SIZE_7: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_7);
-    case BOX_FILTER_SIZE_8: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_8);
-    case BOX_FILTER_SIZE_9: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_9);
-    case BOX_FILTER_SIZE_10: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_10);
-    default: BLUR_ROW_KERNEL (d);
+    case BOX_FILTER_SIZE_2: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_2, DIVIDE);
+    case BOX_FILTER_SIZE_3: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_3, DIVIDE);
+    case BOX_FILTER_SIZE_4: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_4, DIVIDE);
+    case BOX_FILTER_SIZE_5: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_5, DIVIDE);
+    case BOX_FILTER_SIZE_6: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_6, DIVIDE);
+    case BOX_FILTER_SIZE_7: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_7, DIVIDE);
+    case BOX_FILTER_SIZE_8: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_8, DIVIDE);
+    case BOX_FILTER_SIZE_9: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_9, DIVIDE);
+    case BOX_FILTER_SIZE_10: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_10, DIVIDE);
+    default:
+      if (d <= MAX_RECIPROCAL_DIVISOR)
+        {
+          reciprocal = get_reciprocal (d);
+          BLUR_ROW_KERNEL (d, DIVIDE_RECIPROCAL);
+        }
+      else
+        {
+          BLUR_ROW_KERNEL (d, DIVIDE);
+        }
     }
 
+#undef BLUR_ROW_KERNEL
+
   memcpy (row, tmp_buffer, row_width);
 }
 
+/* This is the vertical version of blur_xspan(). It works on a
+ * range of columns at once, so that memory is accessed row by
+ * row and the inner loops can be vectorized by the compiler.
+ * That avoids transposing the buffer.
+ *
+ * sums must have room for n_columns values.
+ */
 static void
-blur_rows (guchar *dst_buffer,
-           guchar *tmp_buffer,
-           int     buffer_width,
-           int     buffer_height,
-           int     d)
+blur_yspan (guchar       *dst,
+            int           dst_stride,
+            const guchar *src,
+            int           src_stride,
+            int           n_columns,
+            int           height,
+            int           d,
+            int           shift,
+            guint        *sums)
 {
-  int i;
+  guint64 reciprocal;
+  int offset;
+  int i, x;
 
-  for (i = 0; i < buffer_height; i++)
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  reciprocal = get_reciprocal (d);
+
+  memset (sums, 0, sizeof (guint) * n_columns);
+
+  for (i = -d + offset; i < height + offset; i++)
     {
-      guchar *row = dst_buffer + i * buffer_width;
-
-      /* We want to produce a symmetric blur that spreads a pixel
-       * equally far to the left and right. If d is odd that happens
-       * naturally, but for d even, we approximate by using a blur
-       * on either side and then a centered blur of size d + 1.
-       * (technique also from the SVG specification)
-       */
-      if (d % 2 == 1)
+      if (i >= 0 && i < height)
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
+          const guchar *in = src + i * src_stride;
+
+          for (x = 0; x < n_columns; x++)
+            sums[x] += in[x];
         }
-      else
+
+      if (i >= offset)
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 1);
-          blur_xspan (row, tmp_buffer, buffer_width, d, -1);
-          blur_xspan (row, tmp_buffer, buffer_width, d + 1, 0);
+          guchar *out = dst + (i - offset) * dst_stride;
+
+          if (i >= d)
+            {
+              const guchar *in = src + (i - d) * src_stride;
+
+              for (x = 0; x < n_columns; x++)
+                sums[x] -= in[x];
+            }
+
+          if (d <= MAX_RECIPROCAL_DIVISOR)
+            {
+              for (x = 0; x < n_columns; x++)
+                out[x] = DIVIDE_RECIPROCAL (sums[x] + d / 2, d);
+            }
+          else
+            {
+              for (x = 0; x < n_columns; x++)
+                out[x] = DIVIDE (sums[x] + d / 2, d);
+            }
         }
     }
 }
 
-/* Swaps width and height.
- */
+#undef DIVIDE
+#undef DIVIDE_RECIPROCAL
+
+/* The number of columns handled by one blur_yspan() call */
+#define COLUMN_CHUNK_SIZE 64
+/* The number of bytes handled by one chunk of rows */
+#define ROW_CHUNK_BYTES 16384
+
+typedef struct _BoxBlur BoxBlur;
+
+struct _BoxBlur
+{
+  guchar *buffer;
+  int width;
+  int height;
+  int d;
+  int row_chunk_size;
+  /* atomic */ int rows_done;
+  /* atomic */ int columns_done;
+};
+
 static void
-flip_buffer (guchar *dst_buffer,
-             guchar *src_buffer,
-             int     width,
-             int     height)
+blur_rows (gpointer data)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once
-   */
-#define BLOCK_SIZE 16
-
-  int i0, j0;
-
-  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-      {
-        int max_j = MIN(j0 + BLOCK_SIZE, height);
-        int max_i = MIN(i0 + BLOCK_SIZE, width);
-        int i, j;
-
-        for (i = i0; i < max_i; i++)
-          for (j = j0; j < max_j; j++)
-            dst_buffer[i * height + j] = src_buffer[j * width + i];
-      }
-#undef BLOCK_SIZE
+  BoxBlur *blur = data;
+  guchar *tmp_buffer;
+  int y0, y;
+
+  tmp_buffer = g_malloc (blur->width);
+
+  for (y0 = g_atomic_int_add (&blur->rows_done, blur->row_chunk_size);
+       y0 < blur->height;
+       y0 = g_atomic_int_add (&blur->rows_done, blur->row_chunk_size))
+    {
+      for (y = y0; y < MIN (y0 + blur->row_chunk_size, blur->height); y++)
+        {
+          guchar *row = blur->buffer + y * blur->width;
+
+          /* We want to produce a symmetric blur that spreads a pixel
+           * equally far to the left and right. If d is odd that happens
+           * naturally, but for d even, we approximate by using a blur
+           * on either side and then a centered blur of size d + 1.
+           * (technique also from the SVG specification)
+           */
+          if (blur->d % 2 == 1)
+            {
+              blur_xspan (row, tmp_buffer, blur->width, blur->d, 0);
+              blur_xspan (row, tmp_buffer, blur->width, blur->d, 0);
+              blur_xspan (row, tmp_buffer, blur->width, blur->d, 0);
+            }
+          else
+            {
+              blur_xspan (row, tmp_buffer, blur->width, blur->d, 1);
+              blur_xspan (row, tmp_buffer, blur->width, blur->d, -1);
+              blur_xspan (row, tmp_buffer, blur->width, blur->d + 1, 0);
+            }
+        }
+    }
+
+  g_free (tmp_buffer);
+}
+
+static void
+blur_columns (gpointer data)
+{
+  BoxBlur *blur = data;
+  guint sums[COLUMN_CHUNK_SIZE];
+  guchar *tmp1, *tmp2;
+  int x0, n_columns;
+
+  tmp1 = g_malloc (COLUMN_CHUNK_SIZE * blur->height);
+  tmp2 = g_malloc (COLUMN_CHUNK_SIZE * blur->height);
+
+  for (x0 = g_atomic_int_add (&blur->columns_done, COLUMN_CHUNK_SIZE);
+       x0 < blur->width;
+       x0 = g_atomic_int_add (&blur->columns_done, COLUMN_CHUNK_SIZE))
+    {
+      guchar *columns = blur->buffer + x0;
+
+      n_columns = MIN (COLUMN_CHUNK_SIZE, blur->width - x0);
+
+      /* See blur_rows() for the even d case */
+      if (blur->d % 2 == 1)
+        {
+          blur_yspan (tmp1, n_columns, columns, blur->width, n_columns, blur->height, blur->d, 0, sums);
+          blur_yspan (tmp2, n_columns, tmp1, n_columns, n_columns, blur->height, blur->d, 0, sums);
+          blur_yspan (columns, blur->width, tmp2, n_columns, n_columns, blur->height, blur->d, 0, sums);
+        }
+      else
+        {
+          blur_yspan (tmp1, n_columns, columns, blur->width, n_columns, blur->height, blur->d, 1, sums);
+          blur_yspan (tmp2, n_columns, tmp1, n_columns, n_columns, blur->height, blur->d, -1, sums);
+          blur_yspan (columns, blur->width, tmp2, n_columns, n_columns, blur->height, blur->d + 1, 0, sums);
+        }
+    }
+
+  g_free (tmp2);
+  g_free (tmp1);
 }
 
 static void
@@ -197,30 +322,32 @@ _boxblur (guchar      *buffer,
           int          radius,
           GskBlurFlags flags)
 {
-  guchar *flipped_buffer;
-  int d = get_box_filter_size (radius);
-
-  flipped_buffer = g_malloc (width * height);
-
+  BoxBlur blur = {
+    .buffer = buffer,
+    .width = width,
+    .height = height,
+    .d = get_box_filter_size (radius),
+    .row_chunk_size = MAX (1, ROW_CHUNK_BYTES / width),
+    .rows_done = 0,
+    .columns_done = 0,
+  };
+
+  /* Columns are done first, so the results match blurring them
+   * after transposing the buffer, like this code used to do.
+   */
   if (flags & GSK_BLUR_Y)
     {
-      /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
-
-      /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
-
-      /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
+      gdk_parallel_task_run (blur_columns,
+                             &blur,
+                             (width + COLUMN_CHUNK_SIZE - 1) / COLUMN_CHUNK_SIZE);
     }
 
   if (flags & GSK_BLUR_X)
     {
-      /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
+      gdk_parallel_task_run (blur_rows,
+                             &blur,
+                             (height + blur.row_chunk_size - 1) / blur.row_chunk_size);
     }
-
-  g_free (flipped_buffer);
 }
 
 /*
@@ -9,6 +9,7 @@ static const GdkDebugKey gsk_debug_keys[] = {
   { "shaders", GSK_DEBUG_SHADERS, "Information about shaders" },
   { "fallback", GSK_DEBUG_FALLBACK, "Information about fallback usage in renderers" },
   { "cache", GSK_DEBUG_CACHE, "Information about caching" },
+  { "memory", GSK_DEBUG_MEMORY, "Print GPU memory usage when collecting caches (Vulkan only)" },
   { "verbose", GSK_DEBUG_VERBOSE, "Print verbose output while rendering" },
   { "diff", GSK_DEBUG_DIFF, "Print the result of diff computations" },
   { "opacity", GSK_DEBUG_OPACITY, "Print the result of every opacity computation" },
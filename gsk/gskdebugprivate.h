@@ -11,18 +11,19 @@ typedef enum {
   GSK_DEBUG_VULKAN                = 1 <<  2,
   GSK_DEBUG_FALLBACK              = 1 <<  3,
   GSK_DEBUG_CACHE                 = 1 <<  4,
-  GSK_DEBUG_VERBOSE               = 1 <<  5,
-  GSK_DEBUG_DIFF                  = 1 <<  6,
-  GSK_DEBUG_OPACITY               = 1 <<  7,
+  GSK_DEBUG_MEMORY                = 1 <<  5,
+  GSK_DEBUG_VERBOSE               = 1 <<  6,
+  GSK_DEBUG_DIFF                  = 1 <<  7,
+  GSK_DEBUG_OPACITY               = 1 <<  8,
   /* flags below may affect behavior */
-  GSK_DEBUG_GEOMETRY              = 1 <<  8,
-  GSK_DEBUG_FULL_REDRAW           = 1 <<  9,
-  GSK_DEBUG_STAGING               = 1 << 10,
-  GSK_DEBUG_CAIRO                 = 1 << 11,
-  GSK_DEBUG_OCCLUSION             = 1 << 12,
+  GSK_DEBUG_GEOMETRY              = 1 <<  9,
+  GSK_DEBUG_FULL_REDRAW           = 1 << 10,
+  GSK_DEBUG_STAGING               = 1 << 11,
+  GSK_DEBUG_CAIRO                 = 1 << 12,
+  GSK_DEBUG_OCCLUSION             = 1 << 13,
 } GskDebugFlags;
 
-#define GSK_DEBUG_ANY ((1 << 12) - 1)
+#define GSK_DEBUG_ANY ((1 << 13) - 1)
 
 GskDebugFlags gsk_get_debug_flags (void);
 void          gsk_set_debug_flags (GskDebugFlags flags);
@@ -38,11 +38,15 @@
 #include "gsktransformnode.h"
 #include "gsktransformprivate.h"
 
+#include "gdkprofilerprivate.h"
 #include "gdkrgbaprivate.h"
 #include "gdksurfaceprivate.h"
 
 #include <graphene.h>
 
+static guint profiler_offloaded_pixels_id;
+static guint profiler_composited_pixels_id;
+
 typedef struct
 {
   GskRoundedRect rect;
@@ -783,6 +787,7 @@ complex_clip:
         else
           {
             info->n_nodes++;
+            info->node_rect = transformed_bounds;
 
             if (info->n_nodes > 1)
               {
@@ -854,6 +859,84 @@ complex_clip:
     pop_clip (self);
 }
 
+static void
+apply_holdoff (GskOffload     *self,
+               GskOffloadInfo *info)
+{
+  GdkSubsurface *subsurface = info->subsurface;
+
+  /* Subsurfaces that vanished from the scene don't need hysteresis */
+  if (info->n_nodes == 0)
+    {
+      subsurface->offload_holdoff = 0;
+      subsurface->raise_holdoff = 0;
+      return;
+    }
+
+  /* Restart the wait on every frame that fails, not just the first */
+  if (!info->can_offload)
+    {
+      if (info->was_offloaded || subsurface->offload_holdoff > 0)
+        subsurface->offload_holdoff = OFFLOAD_HOLDOFF_FRAMES;
+      return;
+    }
+
+  if (!info->was_offloaded && subsurface->offload_holdoff > 0)
+    {
+      subsurface->offload_holdoff--;
+      GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
+                         "[%p] 🗙 Waiting %u more frames before offloading again",
+                         subsurface, subsurface->offload_holdoff);
+      info->can_offload = FALSE;
+      info->can_raise = FALSE;
+      return;
+    }
+
+  if (!info->can_raise)
+    {
+      if (info->was_above || subsurface->raise_holdoff > 0)
+        subsurface->raise_holdoff = OFFLOAD_HOLDOFF_FRAMES;
+      return;
+    }
+
+  if (!info->was_above && subsurface->raise_holdoff > 0)
+    {
+      subsurface->raise_holdoff--;
+      GDK_DISPLAY_DEBUG (gdk_surface_get_display (self->surface), OFFLOAD,
+                         "[%p]   Waiting %u more frames before raising again",
+                         subsurface, subsurface->raise_holdoff);
+      info->can_raise = FALSE;
+    }
+}
+
+static void
+update_profiler_counters (GskOffload *self)
+{
+  gint64 offloaded = 0, composited = 0;
+
+  for (gsize i = 0; i < self->n_subsurfaces; i++)
+    {
+      GskOffloadInfo *info = &self->subsurfaces[i];
+
+      if (info->n_nodes == 0)
+        continue;
+
+      if (info->is_offloaded)
+        offloaded += info->texture_rect.size.width * info->texture_rect.size.height;
+      else
+        composited += info->node_rect.size.width * info->node_rect.size.height;
+    }
+
+  if (profiler_offloaded_pixels_id == 0)
+    {
+      profiler_offloaded_pixels_id = gdk_profiler_define_int_counter ("offloaded-pixels", "Pixels of subsurfaces that are offloaded");
+      profiler_composited_pixels_id = gdk_profiler_define_int_counter ("composited-pixels", "Pixels of subsurfaces that are composited");
+    }
+
+  gdk_profiler_set_int_counter (profiler_offloaded_pixels_id, offloaded);
+  gdk_profiler_set_int_counter (profiler_composited_pixels_id, composited);
+}
+
 GskOffload *
 gsk_offload_new (GdkSurface     *surface,
                  GskRenderNode  *root,
@@ -892,6 +975,13 @@ gsk_offload_new (GdkSurface     *surface,
       pop_clip (self);
     }
 
+  for (gsize i = 0; i < self->n_subsurfaces; i++)
+    {
+      GskOffloadInfo *info = &self->subsurfaces[i];
+
+      apply_holdoff (self, info);
+    }
+
   for (gsize i = 0; i < self->n_subsurfaces; i++)
     {
       GskOffloadInfo *info = &self->subsurfaces[i];
@@ -952,6 +1042,9 @@ gsk_offload_new (GdkSurface     *surface,
 
     }
 
+  if (GDK_PROFILER_IS_RUNNING && self->n_subsurfaces > 0)
+    update_profiler_counters (self);
+
   return self;
 }
 
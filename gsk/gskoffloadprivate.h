@@ -26,6 +26,13 @@
 
 typedef struct _GskOffload GskOffload;
 
+/* How many frames to wait before offloading or raising a subsurface
+ * again after a transient overlap forced us to stop. Each change
+ * causes a full redraw of the subsurface area, so we want to avoid
+ * flipping back and forth.
+ */
+#define OFFLOAD_HOLDOFF_FRAMES 30
+
 typedef struct
 {
   GdkSubsurface *subsurface;
@@ -35,6 +42,7 @@ typedef struct
   graphene_rect_t source_rect;
   GdkDihedral transform;
   graphene_rect_t background_rect;
+  graphene_rect_t node_rect;
 
   guint n_nodes;
 
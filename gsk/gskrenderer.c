@@ -478,6 +478,8 @@ gsk_renderer_render (GskRenderer          *renderer,
 
   renderer_class->render (renderer, root, clip);
 
+  gsk_render_node_report_allocations ();
+
   g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
   cairo_region_destroy (clip);
   g_clear_pointer (&offload, gsk_offload_free);
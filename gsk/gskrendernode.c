@@ -46,6 +46,7 @@
 
 #include "gdk/gdkcairoprivate.h"
 #include "gdk/gdkcolorstateprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 
 #include <graphene-gobject.h>
 
@@ -261,6 +262,23 @@ gsk_render_node_get_type (void)
   return render_node_type__volatile;
 }
 
+typedef struct {
+  GClassInitFunc class_init;
+  gsize instance_size;
+} GskRenderNodeTypeData;
+
+static void
+gsk_render_node_subclass_init (gpointer g_class,
+                               gpointer class_data)
+{
+  GskRenderNodeClass *node_class = g_class;
+  GskRenderNodeTypeData *type_data = class_data;
+
+  node_class->instance_size = type_data->instance_size;
+
+  type_data->class_init (g_class, NULL);
+}
+
 /*< private >
  * gsk_render_node_type_register_static:
  * @node_name: the name of the node
@@ -276,13 +294,20 @@ gsk_render_node_type_register_static (const char     *node_name,
                                       gsize           instance_size,
                                       GClassInitFunc  class_init)
 {
+  GskRenderNodeTypeData *type_data;
   GTypeInfo info;
 
+  /* static types are never unregistered, so this is never freed */
+  type_data = g_new (GskRenderNodeTypeData, 1);
+  type_data->class_init = class_init;
+  type_data->instance_size = instance_size;
+
   info.class_size = sizeof (GskRenderNodeClass);
   info.base_init = NULL;
   info.base_finalize = NULL;
-  info.class_init = class_init;
+  info.class_init = gsk_render_node_subclass_init;
   info.class_finalize = NULL;
+  info.class_data = type_data;
   info.instance_size = instance_size;
   info.n_preallocs = 0;
   info.instance_init = NULL;
@@ -291,6 +316,11 @@ gsk_render_node_type_register_static (const char     *node_name,
   return g_type_register_static (GSK_TYPE_RENDER_NODE, node_name, &info, 0);
 }
 
+static guint profiler_node_allocs_counter;
+static guint profiler_node_bytes_counter;
+static int profiler_node_allocs;
+static gssize profiler_node_bytes;
+
 /*< private >
  * gsk_render_node_alloc:
  * @node_type: the `GType to instantiate
@@ -302,7 +332,43 @@ gsk_render_node_type_register_static (const char     *node_name,
 gpointer
 gsk_render_node_alloc (GType node_type)
 {
-  return g_type_create_instance (node_type);
+  gpointer node;
+
+  node = g_type_create_instance (node_type);
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      g_atomic_int_inc (&profiler_node_allocs);
+      g_atomic_pointer_add (&profiler_node_bytes, GSK_RENDER_NODE_GET_CLASS (node)->instance_size);
+    }
+
+  return node;
+}
+
+/*< private >
+ * gsk_render_node_report_allocations:
+ *
+ * Reports the number of render nodes and the bytes allocated for
+ * them since the last call to the profiler, and resets the counts.
+ *
+ * This is called once per frame by the renderer.
+ */
+void
+gsk_render_node_report_allocations (void)
+{
+  if (!GDK_PROFILER_IS_RUNNING)
+    return;
+
+  if (profiler_node_allocs_counter == 0)
+    {
+      profiler_node_allocs_counter = gdk_profiler_define_int_counter ("render nodes", "Render nodes created per frame");
+      profiler_node_bytes_counter = gdk_profiler_define_int_counter ("render node bytes", "Bytes allocated for render nodes per frame");
+    }
+
+  gdk_profiler_set_int_counter (profiler_node_allocs_counter,
+                                g_atomic_int_exchange (&profiler_node_allocs, 0));
+  gdk_profiler_set_int_counter (profiler_node_bytes_counter,
+                                (gssize) g_atomic_pointer_exchange (&profiler_node_bytes, 0));
 }
 
 /**
@@ -43,6 +43,7 @@
 #include "gdk/gdkcolorstateprivate.h"
 #include "gdk/gdkmemoryformatprivate.h"
 #include "gdk/gdkprivate.h"
+#include "gdk/gdkprofilerprivate.h"
 #include "gdk/gdkrectangleprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdktexturedownloaderprivate.h"
@@ -2305,6 +2306,117 @@ corner_mask_equal (CornerMask *mask1,
     mask1->corner.height == mask2->corner.height;
 }
 
+/* The maximum number of bytes used by cached corner masks.
+ * Masks are evicted least recently used first.
+ */
+#define MAX_CORNER_MASK_CACHE_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+  CornerMask key;
+  cairo_surface_t *mask;
+  gsize size;
+  GList link;
+} CornerMaskEntry;
+
+static struct {
+  GHashTable *entries;
+  GQueue lru; /* most recently used first */
+  gsize size;
+  guint hits;
+  guint misses;
+  guint profiler_size_id;
+  guint profiler_hits_id;
+  guint profiler_misses_id;
+} corner_mask_cache;
+
+static void
+corner_mask_entry_free (gpointer data)
+{
+  CornerMaskEntry *entry = data;
+
+  corner_mask_cache.size -= entry->size;
+  g_queue_unlink (&corner_mask_cache.lru, &entry->link);
+  cairo_surface_destroy (entry->mask);
+  g_free (entry);
+}
+
+static void
+corner_mask_cache_update_counters (void)
+{
+  if (!GDK_PROFILER_IS_RUNNING)
+    return;
+
+  if (corner_mask_cache.profiler_size_id == 0)
+    {
+      corner_mask_cache.profiler_size_id = gdk_profiler_define_int_counter ("shadow-mask-cache-size", "Bytes used by cached shadow corners");
+      corner_mask_cache.profiler_hits_id = gdk_profiler_define_int_counter ("shadow-mask-cache-hits", "Shadow corners drawn from the cache");
+      corner_mask_cache.profiler_misses_id = gdk_profiler_define_int_counter ("shadow-mask-cache-misses", "Shadow corners that had to be blurred");
+    }
+
+  gdk_profiler_set_int_counter (corner_mask_cache.profiler_size_id, corner_mask_cache.size);
+  gdk_profiler_set_int_counter (corner_mask_cache.profiler_hits_id, corner_mask_cache.hits);
+  gdk_profiler_set_int_counter (corner_mask_cache.profiler_misses_id, corner_mask_cache.misses);
+}
+
+static cairo_surface_t *
+corner_mask_cache_lookup (const CornerMask *key)
+{
+  CornerMaskEntry *entry;
+
+  if (corner_mask_cache.entries)
+    entry = g_hash_table_lookup (corner_mask_cache.entries, key);
+  else
+    entry = NULL;
+
+  if (entry == NULL)
+    {
+      corner_mask_cache.misses++;
+      return NULL;
+    }
+
+  g_queue_unlink (&corner_mask_cache.lru, &entry->link);
+  g_queue_push_head_link (&corner_mask_cache.lru, &entry->link);
+  corner_mask_cache.hits++;
+
+  corner_mask_cache_update_counters ();
+
+  return entry->mask;
+}
+
+static void
+corner_mask_cache_add (const CornerMask *key,
+                       cairo_surface_t  *mask)
+{
+  CornerMaskEntry *entry;
+
+  if (corner_mask_cache.entries == NULL)
+    corner_mask_cache.entries = g_hash_table_new_full ((GHashFunc) corner_mask_hash,
+                                                       (GEqualFunc) corner_mask_equal,
+                                                       NULL,
+                                                       corner_mask_entry_free);
+
+  entry = g_new0 (CornerMaskEntry, 1);
+  entry->key = *key;
+  entry->mask = mask;
+  entry->size = cairo_image_surface_get_stride (mask) * cairo_image_surface_get_height (mask);
+  entry->link.data = entry;
+
+  g_queue_push_head_link (&corner_mask_cache.lru, &entry->link);
+  corner_mask_cache.size += entry->size;
+  g_hash_table_replace (corner_mask_cache.entries, &entry->key, entry);
+
+  /* Never evict the new mask, it is about to be used */
+  while (corner_mask_cache.size > MAX_CORNER_MASK_CACHE_SIZE &&
+         corner_mask_cache.lru.tail != &entry->link)
+    {
+      CornerMaskEntry *last = corner_mask_cache.lru.tail->data;
+
+      g_hash_table_remove (corner_mask_cache.entries, &last->key);
+    }
+
+  corner_mask_cache_update_counters ();
+}
+
 static void
 draw_shadow_corner (cairo_t               *cr,
                     GdkColorState         *ccs,
@@ -2324,7 +2436,6 @@ draw_shadow_corner (cairo_t               *cr,
   cairo_pattern_t *pattern;
   cairo_matrix_t matrix;
   float sx, sy;
-  static GHashTable *corner_mask_cache = NULL;
   float max_other;
   CornerMask key;
   gboolean overlapped;
@@ -2412,15 +2523,10 @@ draw_shadow_corner (cairo_t               *cr,
    * mask, so we cache rendered masks based on the blur radius and the
    * corner radius.
    */
-  if (corner_mask_cache == NULL)
-    corner_mask_cache = g_hash_table_new_full ((GHashFunc)corner_mask_hash,
-                                               (GEqualFunc)corner_mask_equal,
-                                               g_free, (GDestroyNotify)cairo_surface_destroy);
-
   key.radius = radius;
   key.corner = box->corner[corner];
 
-  mask = g_hash_table_lookup (corner_mask_cache, &key);
+  mask = corner_mask_cache_lookup (&key);
   if (mask == NULL)
     {
       mask = cairo_surface_create_similar_image (cairo_get_target (cr), CAIRO_FORMAT_A8,
@@ -2433,7 +2539,7 @@ draw_shadow_corner (cairo_t               *cr,
       cairo_fill (mask_cr);
       gsk_cairo_blur_surface (mask, radius, GSK_BLUR_X | GSK_BLUR_Y);
       cairo_destroy (mask_cr);
-      g_hash_table_insert (corner_mask_cache, g_memdup2 (&key, sizeof (key)), mask);
+      corner_mask_cache_add (&key, mask);
     }
 
   gdk_cairo_set_source_color (cr, ccs, color);
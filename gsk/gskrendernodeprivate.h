@@ -71,6 +71,7 @@ struct _GskRenderNodeClass
   GTypeClass parent_class;
 
   GskRenderNodeType node_type;
+  gsize instance_size;
 
   void          (* finalize)                            (GskRenderNode               *node);
   void          (* draw)                                (GskRenderNode               *node,
@@ -111,6 +112,7 @@ GType           gsk_render_node_type_register_static    (const char
                                                          GClassInitFunc               class_init);
 
 gpointer        gsk_render_node_alloc                   (GType                        node_type);
+void            gsk_render_node_report_allocations      (void);
 
 void            _gsk_render_node_unref                  (GskRenderNode               *node);
 
@@ -65,6 +65,21 @@ struct _GtkAtSpiCache
   /* Re-entrancy guard */
   gboolean in_get_items;
 
+  /* Queue<GtkAtSpiContext>, contexts whose AddAccessible signal
+   * has not been emitted yet, in the order they were added
+   */
+  GQueue pending_adds;
+
+  /* HashTable<GtkAtSpiContext, GList>, the links in pending_adds */
+  GHashTable *pending_adds_links;
+  guint pending_adds_id;
+
+  /* HashTable<GtkAtSpiContext, GtkAtSpiContext>, the parents of
+   * pending contexts whose ChildrenChanged signal has been deferred
+   * until their AddAccessible signal
+   */
+  GHashTable *pending_parents;
+
   GtkAtSpiRoot *root;
 };
 
@@ -85,6 +100,10 @@ gtk_at_spi_cache_finalize (GObject *gobject)
 {
   GtkAtSpiCache *self = GTK_AT_SPI_CACHE (gobject);
 
+  g_clear_handle_id (&self->pending_adds_id, g_source_remove);
+  g_queue_clear (&self->pending_adds);
+  g_clear_pointer (&self->pending_adds_links, g_hash_table_unref);
+  g_clear_pointer (&self->pending_parents, g_hash_table_unref);
   g_clear_pointer (&self->contexts_to_path, g_hash_table_unref);
   g_clear_pointer (&self->contexts_by_path, g_hash_table_unref);
   g_clear_object (&self->connection);
@@ -183,7 +202,7 @@ static void
 collect_cached_objects (GtkAtSpiCache   *self,
                         GVariantBuilder *builder)
 {
-  GHashTable *collection = g_hash_table_new (NULL, NULL);
+  GPtrArray *collection;
   GHashTableIter iter;
   gpointer key_p, value_p;
 
@@ -191,27 +210,27 @@ collect_cached_objects (GtkAtSpiCache   *self,
    * table, so we take a snapshot here and return the items we have at the
    * moment of the GetItems() call
    */
+  collection = g_ptr_array_sized_new (g_hash_table_size (self->contexts_by_path));
   g_hash_table_iter_init (&iter, self->contexts_by_path);
   while (g_hash_table_iter_next (&iter, &key_p, &value_p))
-    g_hash_table_add (collection, value_p);
+    g_ptr_array_add (collection, value_p);
 
   g_variant_builder_open (builder, G_VARIANT_TYPE ("(" ITEM_SIGNATURE ")"));
   collect_root (self, builder);
   g_variant_builder_close (builder);
 
-  g_hash_table_iter_init (&iter, collection);
-  while (g_hash_table_iter_next (&iter, &key_p, &value_p))
+  for (guint i = 0; i < collection->len; i++)
     {
       g_variant_builder_open (builder, G_VARIANT_TYPE ("(" ITEM_SIGNATURE ")"));
 
-      GtkAtSpiContext *context = value_p;
+      GtkAtSpiContext *context = g_ptr_array_index (collection, i);
 
       collect_object (self, builder, context);
 
       g_variant_builder_close (builder);
     }
 
-  g_hash_table_unref (collection);
+  g_ptr_array_unref (collection);
 }
 
 static void
@@ -271,6 +290,68 @@ emit_remove_accessible (GtkAtSpiCache   *self,
                                  NULL);
 }
 
+/* Emits the AddAccessible signal for a pending context, followed
+ * by the ChildrenChanged signal that was deferred along with it.
+ *
+ * Collecting the object might re-enter and add or remove contexts,
+ * so the context is dequeued before emitting anything.
+ */
+static void
+announce_context (GtkAtSpiCache   *self,
+                  GtkAtSpiContext *context)
+{
+  GList *link = g_hash_table_lookup (self->pending_adds_links, context);
+  GtkAtSpiContext *parent;
+
+  g_assert (link != NULL);
+
+  g_queue_delete_link (&self->pending_adds, link);
+  g_hash_table_remove (self->pending_adds_links, context);
+
+  parent = g_hash_table_lookup (self->pending_parents, context);
+  g_hash_table_remove (self->pending_parents, context);
+
+  emit_add_accessible (self, context);
+
+  if (parent != NULL)
+    gtk_at_spi_context_emit_child_added (parent, context);
+}
+
+static void
+emit_pending_adds (GtkAtSpiCache *self)
+{
+  g_clear_handle_id (&self->pending_adds_id, g_source_remove);
+
+  /* Emit in the order the contexts were added, so ATs learn about
+   * parents before their children
+   */
+  while (!g_queue_is_empty (&self->pending_adds))
+    announce_context (self, g_queue_peek_head (&self->pending_adds));
+}
+
+/* Forgets about the pending contexts without emitting anything,
+ * for when they have been announced by other means
+ */
+static void
+drop_pending_adds (GtkAtSpiCache *self)
+{
+  g_clear_handle_id (&self->pending_adds_id, g_source_remove);
+  g_queue_clear (&self->pending_adds);
+  g_hash_table_remove_all (self->pending_adds_links);
+  g_hash_table_remove_all (self->pending_parents);
+}
+
+static gboolean
+emit_pending_adds_cb (gpointer data)
+{
+  GtkAtSpiCache *self = data;
+
+  self->pending_adds_id = 0;
+  emit_pending_adds (self);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 handle_cache_method (GDBusConnection       *connection,
                      const gchar           *sender,
@@ -304,6 +385,11 @@ handle_cache_method (GDBusConnection       *connection,
 
       self->in_get_items = FALSE;
 
+      /* The reply contains the pending contexts, with their parent
+       * and index, so the AT knows about them from now on
+       */
+      drop_pending_adds (self);
+
       GTK_DEBUG (A11Y, "Returning %" G_GSIZE_FORMAT " items", g_variant_n_children (items));
 
       g_dbus_method_invocation_return_value (invocation, items);
@@ -388,6 +474,9 @@ gtk_at_spi_cache_init (GtkAtSpiCache *self)
                                                   g_free,
                                                   NULL);
   self->contexts_to_path = g_hash_table_new (NULL, NULL);
+  g_queue_init (&self->pending_adds);
+  self->pending_adds_links = g_hash_table_new (NULL, NULL);
+  self->pending_parents = g_hash_table_new (NULL, NULL);
 }
 
 GtkAtSpiCache *
@@ -430,10 +519,30 @@ gtk_at_spi_cache_add_context (GtkAtSpiCache   *self,
   GTK_DEBUG (A11Y, "Adding context '%s' to cache", path_key);
 
   /* GetItems is safe from re-entrancy, but we still don't want to
-   * emit an unnecessary signal while we're collecting ATContexts
+   * emit an unnecessary signal while we're collecting ATContexts.
+   *
+   * We defer the signal to an idle, so that objects that are created
+   * and destroyed in the same main loop iteration, like rows of a list
+   * that is being rebuilt, never hit the bus.
    */
-  if (!self->in_get_items)
-    emit_add_accessible (self, context);
+  if (self->in_get_items)
+    return;
+
+  g_queue_push_tail (&self->pending_adds, context);
+  g_hash_table_insert (self->pending_adds_links, context, g_queue_peek_tail_link (&self->pending_adds));
+  if (self->pending_adds_id == 0)
+    {
+      self->pending_adds_id = g_idle_add (emit_pending_adds_cb, self);
+      gdk_source_set_static_name_by_id (self->pending_adds_id, "[gtk] AT-SPI cache add");
+    }
+}
+
+static gboolean
+is_parent (gpointer key,
+           gpointer value,
+           gpointer user_data)
+{
+  return value == user_data;
 }
 
 void
@@ -450,7 +559,21 @@ gtk_at_spi_cache_remove_context (GtkAtSpiCache   *self,
   if (!g_hash_table_contains (self->contexts_by_path, path))
     return;
 
-  emit_remove_accessible (self, context);
+  /* If we never announced the object, we don't need to retract it */
+  GList *link = g_hash_table_lookup (self->pending_adds_links, context);
+  if (link != NULL)
+    {
+      g_queue_delete_link (&self->pending_adds, link);
+      g_hash_table_remove (self->pending_adds_links, context);
+      g_hash_table_remove (self->pending_parents, context);
+    }
+  else
+    emit_remove_accessible (self, context);
+
+  /* Pending children can't be announced as children of a context
+   * that is gone
+   */
+  g_hash_table_foreach_remove (self->pending_parents, is_parent, context);
 
   /* The order is important: the value in contexts_by_path is the
    * key in contexts_to_path
@@ -460,3 +583,92 @@ gtk_at_spi_cache_remove_context (GtkAtSpiCache   *self,
 
   GTK_DEBUG (A11Y, "Removing context '%s' from cache", path);
 }
+
+/*< private >
+ * gtk_at_spi_cache_has_pending_add:
+ * @self: a `GtkAtSpiCache`
+ * @context: a `GtkAtSpiContext`
+ *
+ * Checks whether @context was added to the cache, but the
+ * AddAccessible signal for it has not been emitted yet.
+ *
+ * Returns: %TRUE if ATs don't know about @context yet
+ */
+gboolean
+gtk_at_spi_cache_has_pending_add (GtkAtSpiCache   *self,
+                                  GtkAtSpiContext *context)
+{
+  g_return_val_if_fail (GTK_IS_AT_SPI_CACHE (self), FALSE);
+  g_return_val_if_fail (GTK_IS_AT_SPI_CONTEXT (context), FALSE);
+
+  return g_hash_table_contains (self->pending_adds_links, context);
+}
+
+/*< private >
+ * gtk_at_spi_cache_flush_context:
+ * @self: a `GtkAtSpiCache`
+ * @context: a `GtkAtSpiContext`
+ *
+ * Makes sure the AddAccessible signal for @context has been emitted.
+ *
+ * This must be called before emitting other signals that refer to
+ * @context. Only @context and the pending parents it is going to be
+ * announced as a child of are flushed; everything else stays queued.
+ */
+void
+gtk_at_spi_cache_flush_context (GtkAtSpiCache   *self,
+                                GtkAtSpiContext *context)
+{
+  GtkAtSpiContext *parent;
+
+  g_return_if_fail (GTK_IS_AT_SPI_CACHE (self));
+  g_return_if_fail (GTK_IS_AT_SPI_CONTEXT (context));
+
+  if (!g_hash_table_contains (self->pending_adds_links, context))
+    return;
+
+  parent = g_hash_table_lookup (self->pending_parents, context);
+  if (parent != NULL)
+    gtk_at_spi_cache_flush_context (self, parent);
+
+  /* Flushing the parent might have re-entered */
+  if (g_hash_table_contains (self->pending_adds_links, context))
+    announce_context (self, context);
+}
+
+/*< private >
+ * gtk_at_spi_cache_defer_child_changed:
+ * @self: a `GtkAtSpiCache`
+ * @parent: the `GtkAtSpiContext` of the parent
+ * @child: the `GtkAtSpiContext` of the child
+ * @state: whether @child was added or removed
+ *
+ * Defers the ChildrenChanged signal for @child until the
+ * AddAccessible signal for it is emitted, if that is still pending.
+ *
+ * A child that is removed before being announced never reaches
+ * the bus at all.
+ *
+ * Returns: %TRUE if the signal was deferred or dropped, and
+ *   must not be emitted now
+ */
+gboolean
+gtk_at_spi_cache_defer_child_changed (GtkAtSpiCache           *self,
+                                      GtkAtSpiContext         *parent,
+                                      GtkAtSpiContext         *child,
+                                      GtkAccessibleChildState  state)
+{
+  g_return_val_if_fail (GTK_IS_AT_SPI_CACHE (self), FALSE);
+  g_return_val_if_fail (GTK_IS_AT_SPI_CONTEXT (parent), FALSE);
+  g_return_val_if_fail (GTK_IS_AT_SPI_CONTEXT (child), FALSE);
+
+  if (!g_hash_table_contains (self->pending_adds_links, child))
+    return FALSE;
+
+  if (state == GTK_ACCESSIBLE_CHILD_STATE_ADDED)
+    g_hash_table_insert (self->pending_parents, child, parent);
+  else
+    g_hash_table_remove (self->pending_parents, child);
+
+  return TRUE;
+}
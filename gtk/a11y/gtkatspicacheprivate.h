@@ -22,6 +22,7 @@
 
 #include <gio/gio.h>
 #include "gtkatspiprivate.h"
+#include "gtkaccessibleprivate.h"
 
 G_BEGIN_DECLS
 
@@ -42,4 +43,18 @@ void
 gtk_at_spi_cache_remove_context (GtkAtSpiCache *self,
                                  GtkAtSpiContext *context);
 
+gboolean
+gtk_at_spi_cache_has_pending_add (GtkAtSpiCache *self,
+                                  GtkAtSpiContext *context);
+
+void
+gtk_at_spi_cache_flush_context (GtkAtSpiCache *self,
+                                GtkAtSpiContext *context);
+
+gboolean
+gtk_at_spi_cache_defer_child_changed (GtkAtSpiCache *self,
+                                      GtkAtSpiContext *parent,
+                                      GtkAtSpiContext *child,
+                                      GtkAccessibleChildState state);
+
 G_END_DECLS
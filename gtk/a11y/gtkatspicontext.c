@@ -26,6 +26,7 @@
 #include "gtkaccessibletextprivate.h"
 
 #include "gtkatspiactionprivate.h"
+#include "gtkatspicacheprivate.h"
 #include "gtkatspieditabletextprivate.h"
 #include "gtkatspiprivate.h"
 #include "gtkatspirootprivate.h"
@@ -118,6 +119,14 @@ struct _GtkAtSpiContext
 
   guint registration_ids[20];
   guint n_registered_objects;
+
+  /* The last value we emitted for each state, so that we
+   * don't send redundant StateChanged signals
+   */
+  GHashTable *emitted_states;
+
+  /* Bounds changes are coalesced, and emitted once from an idle */
+  guint bounds_changed_id;
 };
 
 G_DEFINE_TYPE (GtkAtSpiContext, gtk_at_spi_context, GTK_TYPE_AT_CONTEXT)
@@ -829,6 +838,19 @@ static const GDBusInterfaceVTable accessible_vtable = {
 };
 /* }}} */
 /* {{{ Change notification */
+/* The cache announces new objects from an idle, and ATs ignore
+ * signals about objects they don't know yet. So emit the pending
+ * AddAccessible signal before any signal referring to @self.
+ */
+static void
+ensure_announced (GtkAtSpiContext *self)
+{
+  GtkAtSpiCache *cache = gtk_at_spi_root_get_cache (self->root);
+
+  if (cache != NULL)
+    gtk_at_spi_cache_flush_context (cache, self);
+}
+
 static void
 emit_text_changed (GtkAtSpiContext *self,
                    const char      *kind,
@@ -839,6 +861,8 @@ emit_text_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -859,6 +883,8 @@ emit_text_selection_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   if (strcmp (kind, "text-caret-moved") == 0)
     g_dbus_connection_emit_signal (self->connection,
                                    NULL,
@@ -886,6 +912,8 @@ emit_selection_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -901,9 +929,26 @@ emit_state_changed (GtkAtSpiContext *self,
                     const char      *name,
                     gboolean         enabled)
 {
+  gpointer value;
+
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
+    {
+      /* Nobody saw what we emitted before */
+      g_clear_pointer (&self->emitted_states, g_hash_table_unref);
+      return;
+    }
+
+  if (self->emitted_states == NULL)
+    self->emitted_states = g_hash_table_new (g_str_hash, g_str_equal);
+
+  if (g_hash_table_lookup_extended (self->emitted_states, name, NULL, &value) &&
+      GPOINTER_TO_INT (value) == enabled)
     return;
 
+  g_hash_table_insert (self->emitted_states, (gpointer) g_intern_string (name), GINT_TO_POINTER (enabled));
+
+  ensure_announced (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -917,9 +962,17 @@ emit_state_changed (GtkAtSpiContext *self,
 static void
 emit_defunct (GtkAtSpiContext *self)
 {
+  GtkAtSpiCache *cache;
+
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  /* Removing the context drops the pending AddAccessible signal,
+   * so the AT never learns about the object at all */
+  cache = gtk_at_spi_root_get_cache (self->root);
+  if (cache != NULL && gtk_at_spi_cache_has_pending_add (cache, self))
+    return;
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -937,14 +990,17 @@ emit_property_changed (GtkAtSpiContext *self,
   GVariant *value_owned = g_variant_ref_sink (value);
 
   if (self->connection != NULL && gtk_at_spi_root_has_event_listeners (self->root))
-    g_dbus_connection_emit_signal (self->connection,
-                                   NULL,
-                                   self->context_path,
-                                   "org.a11y.atspi.Event.Object",
-                                   "PropertyChange",
-                                   g_variant_new ("(siiva{sv})",
-                                                  name, 0, 0, value_owned, NULL),
-                                   NULL);
+    {
+      ensure_announced (self);
+      g_dbus_connection_emit_signal (self->connection,
+                                     NULL,
+                                     self->context_path,
+                                     "org.a11y.atspi.Event.Object",
+                                     "PropertyChange",
+                                     g_variant_new ("(siiva{sv})",
+                                                    name, 0, 0, value_owned, NULL),
+                                     NULL);
+    }
 
   g_variant_unref (value_owned);
 }
@@ -959,6 +1015,8 @@ emit_bounds_changed (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -981,6 +1039,16 @@ emit_children_changed (GtkAtSpiContext         *self,
       !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  /* Children that ATs don't know about yet are announced from
+   * the cache idle, together with this signal
+   */
+  GtkAtSpiCache *cache = gtk_at_spi_root_get_cache (self->root);
+  if (cache != NULL &&
+      gtk_at_spi_cache_defer_child_changed (cache, self, child_context, state))
+    return;
+
+  ensure_announced (self);
+
   GVariant *child_ref = gtk_at_spi_context_to_ref (child_context);
 
   gtk_at_spi_emit_children_changed (self->connection,
@@ -997,6 +1065,8 @@ emit_window_event (GtkAtSpiContext *self,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -1297,28 +1367,44 @@ gtk_at_spi_context_platform_change (GtkATContext                *ctx,
     }
 }
 
-static void
-gtk_at_spi_context_bounds_change (GtkATContext *ctx)
+static gboolean
+emit_pending_bounds_changed (gpointer data)
 {
-  GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
-  GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
+  GtkAtSpiContext *self = data;
+  GtkAccessible *accessible = gtk_at_context_get_accessible (GTK_AT_CONTEXT (self));
   int x, y, width, height;
+
+  self->bounds_changed_id = 0;
+
   if (gtk_accessible_get_bounds (accessible, &x, &y, &width, &height))
     emit_bounds_changed (self, x, y, width, height);
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
-gtk_at_spi_context_child_change (GtkATContext             *ctx,
-                                 GtkAccessibleChildChange  change,
-                                 GtkAccessible            *child)
+gtk_at_spi_context_bounds_change (GtkATContext *ctx)
 {
   GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
-  GtkAccessible *accessible = gtk_at_context_get_accessible (ctx);
-  GtkATContext *child_context = gtk_accessible_get_at_context (child);
 
-  if (child_context == NULL)
+  if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  /* A relayout can change the bounds of an object many times,
+   * only tell ATs about the final result
+   */
+  if (self->bounds_changed_id == 0)
+    {
+      self->bounds_changed_id = g_idle_add (emit_pending_bounds_changed, self);
+      gdk_source_set_static_name_by_id (self->bounds_changed_id, "[gtk] AT-SPI bounds changed");
+    }
+}
+
+static int
+get_child_index (GtkAtSpiContext *self,
+                 GtkAccessible   *child)
+{
+  GtkAccessible *accessible = gtk_at_context_get_accessible (GTK_AT_CONTEXT (self));
   GtkAccessible *parent = gtk_accessible_get_accessible_parent (child);
   int idx = 0;
 
@@ -1336,6 +1422,22 @@ gtk_at_spi_context_child_change (GtkATContext             *ctx,
       g_object_unref (parent);
     }
 
+  return idx;
+}
+
+static void
+gtk_at_spi_context_child_change (GtkATContext             *ctx,
+                                 GtkAccessibleChildChange  change,
+                                 GtkAccessible            *child)
+{
+  GtkAtSpiContext *self = GTK_AT_SPI_CONTEXT (ctx);
+  GtkATContext *child_context = gtk_accessible_get_at_context (child);
+
+  if (child_context == NULL)
+    return;
+
+  int idx = get_child_index (self, child);
+
   if (change & GTK_ACCESSIBLE_CHILD_CHANGE_ADDED)
   {
     gtk_at_context_realize (child_context);
@@ -1536,6 +1638,8 @@ gtk_at_spi_context_finalize (GObject *gobject)
 
   gtk_at_spi_context_unregister_object (self);
 
+  g_clear_handle_id (&self->bounds_changed_id, g_source_remove);
+  g_clear_pointer (&self->emitted_states, g_hash_table_unref);
   g_clear_object (&self->root);
 
   g_free (self->context_path);
@@ -1632,7 +1736,11 @@ gtk_at_spi_context_unrealize (GtkATContext *context)
                    self->context_path,
                    G_OBJECT_TYPE_NAME (accessible));
 
-  /* Notify ATs that the accessible object is going away */
+  /* Notify ATs that the accessible object is going away, there
+   * is no point in telling them about its bounds anymore
+   */
+  g_clear_handle_id (&self->bounds_changed_id, g_source_remove);
+  g_clear_pointer (&self->emitted_states, g_hash_table_unref);
   emit_defunct (self);
   gtk_at_spi_root_unregister (self->root, self);
 
@@ -1655,6 +1763,8 @@ gtk_at_spi_context_announce (GtkATContext                      *context,
   if (self->connection == NULL)
     return;
 
+  ensure_announced (self);
+
   switch (priority)
     {
     case GTK_ACCESSIBLE_ANNOUNCEMENT_PRIORITY_LOW:
@@ -1691,6 +1801,8 @@ gtk_at_spi_context_update_caret_position (GtkATContext *context)
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   offset = gtk_accessible_text_get_caret_position (accessible_text);
 
   g_dbus_connection_emit_signal (self->connection,
@@ -1715,6 +1827,8 @@ gtk_at_spi_context_update_selection_bound (GtkATContext *context)
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   g_dbus_connection_emit_signal (self->connection,
                                  NULL,
                                  self->context_path,
@@ -1740,6 +1854,8 @@ gtk_at_spi_context_update_text_contents (GtkATContext *context,
   if (self->connection == NULL || !gtk_at_spi_root_has_event_listeners (self->root))
     return;
 
+  ensure_announced (self);
+
   GtkAccessible *accessible = gtk_at_context_get_accessible (context);
   if (!GTK_IS_ACCESSIBLE_TEXT (accessible))
     return;
@@ -2074,6 +2190,29 @@ gtk_at_spi_context_get_parent_ref (GtkAtSpiContext *self)
   return get_parent_context_ref (accessible);
 }
 
+/*< private >
+ * gtk_at_spi_context_emit_child_added:
+ * @self: a `GtkAtSpiContext`
+ * @child_context: the `GtkAtSpiContext` of a child
+ *
+ * Emits the ChildrenChanged signal that the cache deferred
+ * until @child_context was announced.
+ */
+void
+gtk_at_spi_context_emit_child_added (GtkAtSpiContext *self,
+                                     GtkAtSpiContext *child_context)
+{
+  g_return_if_fail (GTK_IS_AT_SPI_CONTEXT (self));
+  g_return_if_fail (GTK_IS_AT_SPI_CONTEXT (child_context));
+
+  GtkAccessible *child = gtk_at_context_get_accessible (GTK_AT_CONTEXT (child_context));
+
+  emit_children_changed (self,
+                         child_context,
+                         get_child_index (self, child),
+                         GTK_ACCESSIBLE_CHILD_STATE_ADDED);
+}
+
 GtkAtSpiRoot *
 gtk_at_spi_context_get_root (GtkAtSpiContext *self)
 {
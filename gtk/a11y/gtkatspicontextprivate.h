@@ -43,6 +43,10 @@ gtk_at_spi_context_to_ref (GtkAtSpiContext *self);
 GtkAtSpiRoot *
 gtk_at_spi_context_get_root (GtkAtSpiContext *self);
 
+void
+gtk_at_spi_context_emit_child_added (GtkAtSpiContext *self,
+                                     GtkAtSpiContext *child_context);
+
 GVariant *
 gtk_at_spi_context_get_parent_ref (GtkAtSpiContext *self);
 
@@ -476,6 +476,9 @@ gtk_at_spi_root_child_changed (GtkAtSpiRoot             *self,
     {
       GtkATContext *context = gtk_accessible_get_at_context (child);
 
+      if (self->cache != NULL)
+        gtk_at_spi_cache_flush_context (self->cache, GTK_AT_SPI_CONTEXT (context));
+
       window_ref = gtk_at_spi_context_to_ref (GTK_AT_SPI_CONTEXT (context));
 
       g_object_unref (context);
@@ -247,6 +247,40 @@ record_data_string_lookup (RecordData *data,
   return s;
 }
 
+/* GParamSpec lookups canonicalize names with '_' into a temporary
+ * copy every time. Property names are fixed once the template is
+ * compiled, so do the canonicalization once here instead of on
+ * every instantiation.
+ */
+static gboolean
+needs_canonical_property_name (RecordDataElement *parent,
+                               const char        *element_name)
+{
+  if (parent == NULL || parent->name == NULL ||
+      strcmp (element_name, "property") != 0)
+    return FALSE;
+
+  return strcmp (parent->name->string, "object") == 0 ||
+         strcmp (parent->name->string, "template") == 0;
+}
+
+static RecordDataString *
+record_data_property_name_lookup (RecordData *data,
+                                  const char *str)
+{
+  RecordDataString *s;
+  char *canonical;
+
+  if (strchr (str, '_') == NULL)
+    return record_data_string_lookup (data, str, -1);
+
+  canonical = g_strdelimit (g_strdup (str), "_", '-');
+  s = record_data_string_lookup (data, canonical, -1);
+  g_free (canonical);
+
+  return s;
+}
+
 static void
 record_start_element (GMarkupParseContext  *context,
                       const char           *element_name,
@@ -259,8 +293,10 @@ record_start_element (GMarkupParseContext  *context,
   RecordData *data = user_data;
   RecordDataElement *child;
   RecordDataString *name, **attr_names, **attr_values;
+  gboolean canonicalize_name;
   int i;
 
+  canonicalize_name = needs_canonical_property_name (data->current, element_name);
   name = record_data_string_lookup (data, element_name, -1);
   child = record_data_element_new (data->current, name, n_attrs);
   data->current = child;
@@ -270,7 +306,10 @@ record_start_element (GMarkupParseContext  *context,
   for (i = 0; i < n_attrs; i++)
     {
       attr_names[i] = record_data_string_lookup (data, names[i], -1);
-      attr_values[i] = record_data_string_lookup (data, values[i], -1);
+      if (canonicalize_name && strcmp (names[i], "name") == 0)
+        attr_values[i] = record_data_property_name_lookup (data, values[i]);
+      else
+        attr_values[i] = record_data_string_lookup (data, values[i], -1);
     }
 }
 
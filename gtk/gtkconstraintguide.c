@@ -182,7 +182,7 @@ gtk_constraint_guide_update_constraint (GtkConstraintGuide *guide,
                                               GTK_CONSTRAINT_STRENGTH_REQUIRED);
     }
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (guide->layout));
+  gtk_constraint_layout_changed (guide->layout);
 }
 
 void
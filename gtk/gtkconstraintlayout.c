@@ -228,6 +228,13 @@ struct _GtkConstraintLayoutChild
   int values[LAST_VALUE];
   GtkConstraintRef *constraints[LAST_VALUE];
 
+  /* The allocation computed by the last full solve that included
+   * this child; valid if the serial matches the layout's one
+   */
+  GtkAllocation allocation;
+  int baseline;
+  guint allocation_serial;
+
   /* HashTable<static string, Variable>; a hash table of variables,
    * one for each attribute; we use these to query and suggest the
    * values for the solver. The string is static and does not need
@@ -263,6 +270,23 @@ struct _GtkConstraintLayout
 
   GListStore *constraints_observer;
   GListStore *guides_observer;
+
+  /* Bumped whenever the constraints, guides or child sizes of this
+   * layout change. The solver is shared by all constraint layouts in
+   * the same root, so its own state can't tell us whether our part of
+   * the system changed; but the variables of different layouts are
+   * never related, so our results only depend on our own inputs.
+   */
+  guint inputs_serial;
+
+  /* The size and inputs of the last full solve; if neither changed,
+   * the children allocations can be reused
+   */
+  int allocated_width;
+  int allocated_height;
+  guint allocated_inputs_serial;
+  guint allocation_serial;
+  gboolean has_allocation;
 };
 
 G_DEFINE_TYPE (GtkConstraintLayoutChild, gtk_constraint_layout_child, GTK_TYPE_LAYOUT_CHILD)
@@ -289,6 +313,21 @@ gtk_constraint_layout_get_solver (GtkConstraintLayout *self)
   return self->solver;
 }
 
+/*< private >
+ * gtk_constraint_layout_changed:
+ * @self: a `GtkConstraintLayout`
+ *
+ * Notes that the constraints or guides of @self changed, and
+ * queues a resize of the layout's widget.
+ */
+void
+gtk_constraint_layout_changed (GtkConstraintLayout *self)
+{
+  self->inputs_serial++;
+
+  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (self));
+}
+
 static const char * const attribute_names[] = {
   [GTK_CONSTRAINT_ATTRIBUTE_NONE]     = "none",
   [GTK_CONSTRAINT_ATTRIBUTE_LEFT]     = "left",
@@ -880,6 +919,7 @@ update_child_constraint (GtkConstraintLayout       *self,
   if (child_info->values[index] != value)
     {
       child_info->values[index] = value;
+      self->inputs_serial++;
 
       if (child_info->constraints[index])
         gtk_constraint_solver_remove_constraint (self->solver,
@@ -1010,6 +1050,51 @@ gtk_constraint_layout_measure (GtkLayoutManager *manager,
     *natural = nat_value;
 }
 
+static gboolean
+gtk_constraint_layout_reuse_allocation (GtkConstraintLayout *self,
+                                        GtkWidget           *widget,
+                                        int                  width,
+                                        int                  height)
+{
+  GtkLayoutManager *manager = GTK_LAYOUT_MANAGER (self);
+  GtkWidget *child;
+
+  if (!self->has_allocation ||
+      self->allocated_width != width ||
+      self->allocated_height != height ||
+      self->allocated_inputs_serial != self->inputs_serial)
+    return FALSE;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      GtkConstraintLayoutChild *info;
+
+      if (!gtk_widget_should_layout (child))
+        continue;
+
+      info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+      if (info->allocation_serial != self->allocation_serial)
+        return FALSE;
+    }
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      GtkConstraintLayoutChild *info;
+
+      if (!gtk_widget_should_layout (child))
+        continue;
+
+      info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+      gtk_widget_size_allocate (child, &info->allocation, info->baseline);
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_constraint_layout_allocate (GtkLayoutManager *manager,
                                 GtkWidget        *widget,
@@ -1028,6 +1113,17 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   if (solver == NULL)
     return;
 
+  /* Nothing changed in our part of the constraint system since the
+   * last time we solved it for this size, so the results are still valid
+   */
+  if (gtk_constraint_layout_reuse_allocation (self, widget, width, height))
+    {
+      GTK_DEBUG (LAYOUT, "Layout [%p]: reusing allocation for %dx%d", self, width, height);
+      return;
+    }
+
+  self->allocation_serial++;
+
   /* We add required stay constraints to ensure that the layout remains
    * within the bounds of the allocation
    */
@@ -1065,6 +1161,7 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
     {
       GtkConstraintVariable *var_top, *var_left, *var_width, *var_height;
       GtkConstraintVariable *var_baseline;
+      GtkConstraintLayoutChild *info;
       GtkAllocation child_alloc;
       int child_baseline = -1;
 
@@ -1094,6 +1191,11 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
       if (gtk_constraint_variable_get_value (var_baseline) > 0)
         child_baseline = floor (gtk_constraint_variable_get_value (var_baseline));
 
+      info = GTK_CONSTRAINT_LAYOUT_CHILD (gtk_layout_manager_get_layout_child (manager, child));
+      info->allocation = child_alloc;
+      info->baseline = child_baseline;
+      info->allocation_serial = self->allocation_serial;
+
       gtk_widget_size_allocate (GTK_WIDGET (child),
                                 &child_alloc,
                                 child_baseline);
@@ -1126,6 +1228,18 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   gtk_constraint_solver_remove_constraint (solver, stay_h);
   gtk_constraint_solver_remove_constraint (solver, stay_t);
   gtk_constraint_solver_remove_constraint (solver, stay_l);
+
+  if (GTK_DEBUG_CHECK (CONSTRAINTS))
+    {
+      char *stats = gtk_constraint_solver_statistics (solver);
+      g_print ("Solver statistics after allocating layout %p:\n%s", self, stats);
+      g_free (stats);
+    }
+
+  self->allocated_width = width;
+  self->allocated_height = height;
+  self->allocated_inputs_serial = self->inputs_serial;
+  self->has_allocation = TRUE;
 }
 
 static void
@@ -1184,6 +1298,7 @@ gtk_constraint_layout_unroot (GtkLayoutManager *manager)
     }
 
   self->solver = NULL;
+  self->has_allocation = FALSE;
 }
 
 static void
@@ -1702,7 +1817,7 @@ gtk_constraint_layout_custom_finished (GtkBuildable *buildable,
             g_list_store_append (data->layout->constraints_observer, c);
         }
 
-      gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (data->layout));
+      gtk_constraint_layout_changed (data->layout);
 
       g_list_free_full (data->constraints, constraint_data_free);
       g_list_free_full (data->guides, guide_data_free);
@@ -1767,7 +1882,7 @@ gtk_constraint_layout_add_constraint (GtkConstraintLayout *layout,
   if (layout->constraints_observer)
     g_list_store_append (layout->constraints_observer, constraint);
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (layout));
+  gtk_constraint_layout_changed (layout);
 }
 
 static void
@@ -1811,7 +1926,7 @@ gtk_constraint_layout_remove_constraint (GtkConstraintLayout *layout,
   if (layout->constraints_observer)
     list_store_remove_item (layout->constraints_observer, constraint);
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (layout));
+  gtk_constraint_layout_changed (layout);
 }
 
 /**
@@ -1839,7 +1954,7 @@ gtk_constraint_layout_remove_all_constraints (GtkConstraintLayout *layout)
   if (layout->constraints_observer)
     g_list_store_remove_all (layout->constraints_observer);
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (layout));
+  gtk_constraint_layout_changed (layout);
 }
 
 /**
@@ -1870,7 +1985,7 @@ gtk_constraint_layout_add_guide (GtkConstraintLayout *layout,
 
   gtk_constraint_guide_update (guide);
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (layout));
+  gtk_constraint_layout_changed (layout);
 
 }
 
@@ -1897,7 +2012,7 @@ gtk_constraint_layout_remove_guide (GtkConstraintLayout *layout,
   if (layout->guides_observer)
     list_store_remove_item (layout->guides_observer, guide);
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (layout));
+  gtk_constraint_layout_changed (layout);
 }
 
 static GtkConstraintAttribute
@@ -2126,7 +2241,7 @@ gtk_constraint_layout_add_constraints_from_descriptionv (GtkConstraintLayout *la
 
   gtk_constraint_vfl_parser_free (parser);
 
-  gtk_layout_manager_layout_changed (GTK_LAYOUT_MANAGER (layout));
+  gtk_constraint_layout_changed (layout);
 
   return res;
 }
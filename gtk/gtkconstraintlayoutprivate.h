@@ -27,6 +27,9 @@ G_BEGIN_DECLS
 GtkConstraintSolver *
 gtk_constraint_layout_get_solver (GtkConstraintLayout *layout);
 
+void
+gtk_constraint_layout_changed (GtkConstraintLayout *layout);
+
 GtkConstraintVariable *
 gtk_constraint_layout_get_attribute (GtkConstraintLayout    *layout,
                                      GtkConstraintAttribute  attr,
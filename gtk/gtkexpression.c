@@ -23,6 +23,8 @@
 
 #include "gtkprivate.h"
 
+#include "gdk/gdkprofilerprivate.h"
+
 #include <gobject/gvaluecollector.h>
 
 /**
@@ -1263,55 +1265,211 @@ gtk_property_expression_evaluate (GtkExpression *expr,
 }
 
 typedef struct _GtkPropertyExpressionWatch GtkPropertyExpressionWatch;
+typedef struct _GtkPropertySubscription GtkPropertySubscription;
 
 struct _GtkPropertyExpressionWatch
 {
-  GtkExpressionNotify    notify;
-  gpointer               user_data;
+  GtkExpressionNotify      notify;
+  gpointer                 user_data;
 
-  GtkPropertyExpression *expr;
-  gpointer               this;
-  GClosure              *closure;
-  guchar                 sub[0];
+  GtkPropertyExpression   *expr;
+  gpointer                 this;
+  GtkPropertySubscription *subscription;
+  guchar                   sub[0];
+};
+
+/* All watches of the same property on the same object share a
+ * single notify handler, so that binding many expressions to the
+ * same object does not grow its handler list, and connecting or
+ * disconnecting a watch does not need to walk it.
+ *
+ * The subscriptions of an object are stored in a hash table in its
+ * qdata, which holds a reference on each of them; every watch holds
+ * another one. When the object goes away, the subscriptions stay
+ * alive until the last watch lets go, with @object unset.
+ */
+struct _GtkPropertySubscription
+{
+  guint ref_count;
+
+  GObject *object;
+  GParamSpec *pspec;
+  gulong handler_id;
+
+  /* Vec<GtkPropertyExpressionWatch> */
+  GPtrArray *watches;
 };
 
+static GQuark property_subscriptions_quark;
+static guint shared_subscriptions_counter;
+static guint n_shared_subscriptions;
+
+static GtkPropertySubscription *
+gtk_property_subscription_ref (GtkPropertySubscription *self)
+{
+  self->ref_count++;
+
+  return self;
+}
+
 static void
-gtk_property_expression_watch_destroy_closure (GtkPropertyExpressionWatch *pwatch)
+gtk_property_subscription_unref (GtkPropertySubscription *self)
 {
-  if (pwatch->closure == NULL)
+  self->ref_count--;
+  if (self->ref_count > 0)
     return;
 
-  g_closure_invalidate (pwatch->closure);
-  g_closure_unref (pwatch->closure);
-  pwatch->closure = NULL;
+  g_assert (self->watches->len == 0);
+
+  g_ptr_array_unref (self->watches);
+  g_free (self);
 }
 
 static void
-gtk_property_expression_watch_notify_cb (GObject                    *object,
-                                         GParamSpec                 *pspec,
-                                         GtkPropertyExpressionWatch *pwatch)
+gtk_property_subscription_detach (gpointer data)
 {
-  pwatch->notify (pwatch->user_data);
+  GtkPropertySubscription *self = data;
+
+  /* Called when the object is finalized, or when the last watch
+   * went away; in the former case the handler is already gone
+   */
+  self->object = NULL;
+  self->handler_id = 0;
+  gtk_property_subscription_unref (self);
 }
 
 static void
-gtk_property_expression_watch_create_closure (GtkPropertyExpressionWatch *pwatch)
+gtk_property_subscription_notify_cb (GObject                 *object,
+                                     GParamSpec              *pspec,
+                                     GtkPropertySubscription *self)
 {
+  GtkPropertyExpressionWatch *pwatch;
+  GPtrArray *watches;
+  guint i;
+
+  if (self->watches->len == 1)
+    {
+      pwatch = g_ptr_array_index (self->watches, 0);
+      pwatch->notify (pwatch->user_data);
+      return;
+    }
+
+  /* Watches may be added or removed while we are notifying them,
+   * so iterate over a copy and skip the ones that went away
+   */
+  gtk_property_subscription_ref (self);
+  watches = g_ptr_array_copy (self->watches, NULL, NULL);
+
+  for (i = 0; i < watches->len; i++)
+    {
+      pwatch = g_ptr_array_index (watches, i);
+
+      if (!g_ptr_array_find (self->watches, pwatch, NULL))
+        continue;
+
+      pwatch->notify (pwatch->user_data);
+    }
+
+  g_ptr_array_unref (watches);
+  gtk_property_subscription_unref (self);
+}
+
+static void
+gtk_property_subscription_update_counter (void)
+{
+  if (G_UNLIKELY (shared_subscriptions_counter == 0))
+    shared_subscriptions_counter = gdk_profiler_define_int_counter ("shared expression watches",
+                                                                    "Number of expression watches sharing a notify handler");
+
+  if (GDK_PROFILER_IS_RUNNING)
+    gdk_profiler_set_int_counter (shared_subscriptions_counter, n_shared_subscriptions);
+}
+
+static void
+gtk_property_expression_watch_unsubscribe (GtkPropertyExpressionWatch *pwatch)
+{
+  GtkPropertySubscription *subscription = pwatch->subscription;
+
+  if (subscription == NULL)
+    return;
+
+  pwatch->subscription = NULL;
+  g_ptr_array_remove_fast (subscription->watches, pwatch);
+
+  if (subscription->watches->len > 0)
+    {
+      n_shared_subscriptions--;
+      gtk_property_subscription_update_counter ();
+    }
+  else if (subscription->object != NULL)
+    {
+      GHashTable *subscriptions;
+
+      /* The handler is gone already if the object was disposed */
+      if (g_signal_handler_is_connected (subscription->object, subscription->handler_id))
+        g_signal_handler_disconnect (subscription->object, subscription->handler_id);
+
+      /* Drops the reference held by the object */
+      subscriptions = g_object_get_qdata (subscription->object, property_subscriptions_quark);
+      g_hash_table_remove (subscriptions, subscription->pspec);
+    }
+
+  gtk_property_subscription_unref (subscription);
+}
+
+static void
+gtk_property_expression_watch_subscribe (GtkPropertyExpressionWatch *pwatch)
+{
+  GtkPropertySubscription *subscription;
+  GHashTable *subscriptions;
+  GParamSpec *pspec = pwatch->expr->pspec;
   GObject *object;
 
   object = gtk_property_expression_get_object (pwatch->expr, pwatch->this);
   if (object == NULL)
     return;
 
-  pwatch->closure = g_cclosure_new (G_CALLBACK (gtk_property_expression_watch_notify_cb), pwatch, NULL);
-  if (!g_signal_connect_closure_by_id (object,
-                                       g_signal_lookup ("notify", G_OBJECT_TYPE (object)),
-                                       g_quark_from_string (pwatch->expr->pspec->name),
-                                       g_closure_ref (pwatch->closure),
-                                       FALSE))
+  if (G_UNLIKELY (property_subscriptions_quark == 0))
+    property_subscriptions_quark = g_quark_from_static_string ("gtk-expression-property-subscriptions");
+
+  subscriptions = g_object_get_qdata (object, property_subscriptions_quark);
+  if (subscriptions == NULL)
+    {
+      subscriptions = g_hash_table_new_full (NULL, NULL, NULL, gtk_property_subscription_detach);
+      g_object_set_qdata_full (object,
+                               property_subscriptions_quark,
+                               subscriptions,
+                               (GDestroyNotify) g_hash_table_unref);
+    }
+
+  subscription = g_hash_table_lookup (subscriptions, pspec);
+  if (subscription == NULL)
     {
-      g_assert_not_reached ();
+      subscription = g_new0 (GtkPropertySubscription, 1);
+      subscription->ref_count = 1;
+      subscription->object = object;
+      subscription->pspec = pspec;
+      subscription->watches = g_ptr_array_new ();
+      subscription->handler_id =
+        g_signal_connect_closure_by_id (object,
+                                        g_signal_lookup ("notify", G_TYPE_OBJECT),
+                                        g_param_spec_get_name_quark (pspec),
+                                        g_cclosure_new (G_CALLBACK (gtk_property_subscription_notify_cb),
+                                                        subscription,
+                                                        NULL),
+                                        FALSE);
+      g_assert (subscription->handler_id != 0);
+
+      g_hash_table_insert (subscriptions, pspec, subscription);
     }
+  else
+    {
+      n_shared_subscriptions++;
+      gtk_property_subscription_update_counter ();
+    }
+
+  g_ptr_array_add (subscription->watches, pwatch);
+  pwatch->subscription = gtk_property_subscription_ref (subscription);
 
   g_object_unref (object);
 }
@@ -1321,8 +1479,8 @@ gtk_property_expression_watch_expr_notify_cb (gpointer data)
 {
   GtkPropertyExpressionWatch *pwatch = data;
 
-  gtk_property_expression_watch_destroy_closure (pwatch);
-  gtk_property_expression_watch_create_closure (pwatch);
+  gtk_property_expression_watch_unsubscribe (pwatch);
+  gtk_property_expression_watch_subscribe (pwatch);
   pwatch->notify (pwatch->user_data);
 }
 
@@ -1362,7 +1520,7 @@ gtk_property_expression_watch (GtkExpression         *expr,
                                     pwatch);
     }
 
-  gtk_property_expression_watch_create_closure (pwatch);
+  gtk_property_expression_watch_subscribe (pwatch);
 }
 
 static void
@@ -1372,7 +1530,7 @@ gtk_property_expression_unwatch (GtkExpression         *expr,
   GtkPropertyExpressionWatch *pwatch = (GtkPropertyExpressionWatch *) watch;
   GtkPropertyExpression *self = (GtkPropertyExpression *) expr;
 
-  gtk_property_expression_watch_destroy_closure (pwatch);
+  gtk_property_expression_watch_unsubscribe (pwatch);
 
   if (self->expr && !gtk_expression_is_static (self->expr))
     gtk_expression_subwatch_finish (self->expr, (GtkExpressionSubWatch *) pwatch->sub);
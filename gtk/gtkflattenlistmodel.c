@@ -49,6 +49,10 @@ struct _FlattenNode
 {
   GListModel *model;
   GtkFlattenListModel *list;
+  /* The number of items in model, updated from items-changed so
+   * that walking the tree does not need to call into submodels
+   */
+  guint n_items;
 };
 
 struct _FlattenAugment
@@ -96,7 +100,7 @@ gtk_flatten_list_model_get_nth (GtkRbTree *tree,
           position -= aug->n_items;
         }
 
-      model_n_items = g_list_model_get_n_items (node->model);
+      model_n_items = node->n_items;
       if (position < model_n_items)
         break;
       position -= model_n_items;
@@ -139,7 +143,7 @@ gtk_flatten_list_model_get_nth_model (GtkRbTree *tree,
       if (position == 0)
         break;
       position--;
-      before += g_list_model_get_n_items (node->model);
+      before += node->n_items;
 
       node = gtk_rb_tree_node_get_right (node);
     }
@@ -219,7 +223,7 @@ gtk_flatten_list_model_get_section (GtkSectionModel *model,
     }
 
   *out_start = position - model_pos;
-  *out_end = position - model_pos + g_list_model_get_n_items (node->model);
+  *out_end = position - model_pos + node->n_items;
 }
 
 static void
@@ -245,6 +249,7 @@ gtk_flatten_list_model_items_changed_cb (GListModel *model,
   GtkFlattenListModel *self = node->list;
   guint real_position;
 
+  node->n_items = node->n_items - removed + added;
   gtk_rb_tree_node_mark_dirty (node);
   real_position = position;
 
@@ -267,7 +272,7 @@ gtk_flatten_list_model_items_changed_cb (GListModel *model,
               FlattenAugment *aug = gtk_rb_tree_get_augment (self->items, left);
               real_position += aug->n_items;
             }
-          real_position += g_list_model_get_n_items (parent->model);
+          real_position += parent->n_items;
         }
     }
 
@@ -295,7 +300,7 @@ gtk_flatten_list_model_augment (GtkRbTree *flatten,
   FlattenNode *node = _node;
   FlattenAugment *aug = _aug;
 
-  aug->n_items = g_list_model_get_n_items (node->model);
+  aug->n_items = node->n_items;
   aug->n_models = 1;
 
   if (left)
@@ -331,7 +336,8 @@ gtk_flatten_list_model_add_items (GtkFlattenListModel *self,
                         G_CALLBACK (gtk_flatten_list_model_items_changed_cb),
                         node);
       node->list = self;
-      added += g_list_model_get_n_items (node->model);
+      node->n_items = g_list_model_get_n_items (node->model);
+      added += node->n_items;
     }
 
   return added;
@@ -401,7 +407,7 @@ gtk_flatten_list_model_model_items_changed_cb (GListModel          *model,
   for (i = 0; i < removed; i++)
     {
       FlattenNode *next = gtk_rb_tree_node_get_next (node);
-      real_removed += g_list_model_get_n_items (node->model);
+      real_removed += node->n_items;
       gtk_rb_tree_remove (self->items, node);
       node = next;
     }
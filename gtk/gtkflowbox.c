@@ -4056,16 +4056,34 @@ gtk_flow_box_bound_model_changed (GListModel *list,
 {
   GtkFlowBox *box = user_data;
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gboolean selection_changed = FALSE;
   int i;
 
-  while (removed--)
+  if (removed > 0)
     {
-      GtkFlowBoxChild *child;
+      GSequenceIter *iter, *next;
+
+      iter = g_sequence_get_iter_at_pos (priv->children, position);
+      while (removed--)
+        {
+          GtkFlowBoxChild *child = g_sequence_get (iter);
+
+          next = g_sequence_iter_next (iter);
+
+          /* Deselect children before removing them, so that removing
+           * a range of selected children only emits one signal
+           */
+          if (gtk_flow_box_child_set_selected (child, FALSE))
+            selection_changed = TRUE;
 
-      child = gtk_flow_box_get_child_at_index (box, position);
-      gtk_flow_box_remove (box, GTK_WIDGET (child));
+          gtk_flow_box_remove (box, GTK_WIDGET (child));
+          iter = next;
+        }
     }
 
+  if (selection_changed && !gtk_widget_in_destruction (GTK_WIDGET (box)))
+    g_signal_emit (box, signals[SELECTED_CHILDREN_CHANGED], 0);
+
   for (i = 0; i < added; i++)
     {
       GObject *item;
@@ -4409,6 +4427,10 @@ gtk_flow_box_check_model_compat (GtkFlowBox *box)
  * Note that using a model is incompatible with the filtering and sorting
  * functionality in `GtkFlowBox`. When using a model, filtering and sorting
  * should be implemented by the model.
+ *
+ * A child is created for every item in @model, so this is not suitable
+ * for large models; use [class@Gtk.GridView] for those, which only
+ * creates widgets for the visible items and recycles them.
  */
 void
 gtk_flow_box_bind_model (GtkFlowBox                 *box,
@@ -2337,6 +2337,11 @@ gtk_list_box_update_header (GtkListBox    *box,
     return;
 
   row = g_sequence_get (iter);
+
+  /* Nothing to do, and no need to look for the previous visible row */
+  if (box->update_header_func == NULL && ROW_PRIV (row)->header == NULL)
+    return;
+
   g_object_ref (row);
 
   before_iter = gtk_list_box_get_previous_visible (box, iter);
@@ -4012,14 +4017,35 @@ gtk_list_box_bound_model_changed (GListModel *list,
                                   gpointer    user_data)
 {
   GtkListBox *box = user_data;
+  gboolean selection_changed = FALSE;
   guint i;
 
-  while (removed--)
+  if (removed > 0)
     {
-      GtkListBoxRow *row;
+      GSequenceIter *iter, *next;
+
+      iter = g_sequence_get_iter_at_pos (box->children, position);
+      while (removed--)
+        {
+          GtkListBoxRow *row = g_sequence_get (iter);
+
+          next = g_sequence_iter_next (iter);
+
+          /* Deselect rows before removing them, so that removing a range
+           * of selected rows only emits the selection signals once
+           */
+          if (gtk_list_box_row_set_selected (row, FALSE))
+            selection_changed = TRUE;
+
+          gtk_list_box_remove (box, GTK_WIDGET (row));
+          iter = next;
+        }
+    }
 
-      row = gtk_list_box_get_row_at_index (box, position);
-      gtk_list_box_remove (box, GTK_WIDGET (row));
+  if (selection_changed && !gtk_widget_in_destruction (GTK_WIDGET (box)))
+    {
+      g_signal_emit (box, signals[ROW_SELECTED], 0, NULL);
+      g_signal_emit (box, signals[SELECTED_ROWS_CHANGED], 0);
     }
 
   for (i = 0; i < added; i++)
@@ -4079,6 +4105,10 @@ gtk_list_box_check_model_compat (GtkListBox *box)
  * Note that using a model is incompatible with the filtering and sorting
  * functionality in `GtkListBox`. When using a model, filtering and sorting
  * should be implemented by the model.
+ *
+ * A row is created for every item in @model, so this is not suitable
+ * for large models; use [class@Gtk.ListView] for those, which only
+ * creates widgets for the visible items and recycles them.
  */
 void
 gtk_list_box_bind_model (GtkListBox                 *box,
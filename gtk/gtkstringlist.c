@@ -69,12 +69,6 @@
  * for property bindings and expressions.
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
-#include "gdk/gdkarrayimpl.c"
-
 struct _GtkStringObject
 {
   GObject parent_instance;
@@ -190,11 +184,53 @@ gtk_string_object_get_string (GtkStringObject *self)
 /* }}} */
 /* {{{ List model implementation */
 
+/* Items are stored as plain strings until somebody asks for the
+ * object wrapping them, so that large lists don't need to create
+ * one GObject per string up front. Strings are tagged by setting
+ * the lowest bit of the pointer, which is never set for malloc()ed
+ * memory or for objects.
+ */
+#define ITEM_IS_STRING(item) (GPOINTER_TO_SIZE (item) & 1)
+#define ITEM_FROM_STRING(str) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (str) | 1)
+#define ITEM_TO_STRING(item) ((char *) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (item) & ~(gsize) 1))
+
+static void
+item_free (gpointer item)
+{
+  if (ITEM_IS_STRING (item))
+    g_free (ITEM_TO_STRING (item));
+  else
+    g_object_unref (item);
+}
+
+static inline const char *
+item_get_string (gpointer item)
+{
+  if (ITEM_IS_STRING (item))
+    return ITEM_TO_STRING (item);
+  else
+    return ((GtkStringObject *) item)->string;
+}
+
+static inline gpointer
+item_new_take (char *string)
+{
+  g_assert (!ITEM_IS_STRING (string));
+
+  return ITEM_FROM_STRING (string);
+}
+
+#define GDK_ARRAY_ELEMENT_TYPE gpointer
+#define GDK_ARRAY_NAME items
+#define GDK_ARRAY_TYPE_NAME Items
+#define GDK_ARRAY_FREE_FUNC item_free
+#include "gdk/gdkarrayimpl.c"
+
 struct _GtkStringList
 {
   GObject parent_instance;
 
-  Objects items;
+  Items items;
 };
 
 struct _GtkStringListClass
@@ -213,7 +249,7 @@ gtk_string_list_get_n_items (GListModel *list)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  return objects_get_size (&self->items);
+  return items_get_size (&self->items);
 }
 
 static gpointer
@@ -221,11 +257,16 @@ gtk_string_list_get_item (GListModel *list,
                           guint       position)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
+  gpointer *item;
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  item = items_index (&self->items, position);
+  if (ITEM_IS_STRING (*item))
+    *item = gtk_string_object_new_take (ITEM_TO_STRING (*item));
+
+  return g_object_ref (*item);
 }
 
 static void
@@ -430,7 +471,7 @@ gtk_string_list_dispose (GObject *object)
 {
   GtkStringList *self = GTK_STRING_LIST (object);
 
-  objects_clear (&self->items);
+  items_clear (&self->items);
 
   G_OBJECT_CLASS (gtk_string_list_parent_class)->dispose (object);
 }
@@ -531,7 +572,7 @@ gtk_string_list_class_init (GtkStringListClass *class)
 static void
 gtk_string_list_init (GtkStringList *self)
 {
-  objects_init (&self->items);
+  items_init (&self->items);
 }
 
 /* }}} */
@@ -583,18 +624,18 @@ gtk_string_list_splice (GtkStringList      *self,
 
   g_return_if_fail (GTK_IS_STRING_LIST (self));
   g_return_if_fail (position + n_removals >= position); /* overflow */
-  g_return_if_fail (position + n_removals <= objects_get_size (&self->items));
+  g_return_if_fail (position + n_removals <= items_get_size (&self->items));
 
   if (additions)
     n_additions = g_strv_length ((char **) additions);
   else
     n_additions = 0;
 
-  objects_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+  items_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
 
   for (i = 0; i < n_additions; i++)
     {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
+      *items_index (&self->items, position + i) = item_new_take (g_strdup (additions[i]));
     }
 
   if (n_removals || n_additions)
@@ -620,9 +661,9 @@ gtk_string_list_append (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
+  items_append (&self->items, item_new_take (g_strdup (string)));
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
 }
 
@@ -647,9 +688,9 @@ gtk_string_list_take (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  items_append (&self->items, item_new_take (string));
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_ITEMS]);
 }
 
@@ -692,10 +733,10 @@ gtk_string_list_get_string (GtkStringList *self,
 {
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  return item_get_string (items_get (&self->items, position));
 }
 
 /**
@@ -721,10 +762,10 @@ gtk_string_list_find (GtkStringList *self,
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), G_MAXUINT);
 
   position = G_MAXUINT;
-  items_size = objects_get_size (&self->items);
+  items_size = items_get_size (&self->items);
   for (guint i = 0; i < items_size; i++)
   {
-    if (strcmp (string, objects_get (&self->items, i)->string) == 0)
+    if (strcmp (string, item_get_string (items_get (&self->items, i))) == 0)
     {
       position = i;
       break;
@@ -529,6 +529,37 @@ gtk_tree_list_model_collapse_node (GtkTreeListModel *self,
   return n_items;
 }
 
+static void
+gtk_tree_list_model_expand_node_to_depth (GtkTreeListModel *self,
+                                          TreeNode         *node,
+                                          guint             depth,
+                                          GPtrArray        *expanded_rows)
+{
+  TreeNode *child;
+
+  if (depth == 0)
+    return;
+
+  if (node->model == NULL)
+    {
+      gtk_tree_list_model_expand_node (self, node);
+      if (node->model == NULL)
+        return;
+
+      if (node->row)
+        g_ptr_array_add (expanded_rows, g_object_ref (node->row));
+    }
+
+  if (depth == 1)
+    return;
+
+  for (child = gtk_rb_tree_get_first (node->children);
+       child != NULL;
+       child = gtk_rb_tree_node_get_next (child))
+    {
+      gtk_tree_list_model_expand_node_to_depth (self, child, depth - 1, expanded_rows);
+    }
+}
 
 static GType
 gtk_tree_list_model_get_item_type (GListModel *list)
@@ -1218,6 +1249,64 @@ gtk_tree_list_row_set_expanded (GtkTreeListRow *self,
   g_object_notify_by_pspec (G_OBJECT (self), row_properties[ROW_PROP_CHILDREN]);
 }
 
+/**
+ * gtk_tree_list_row_expand_to_depth:
+ * @self: a `GtkTreeListRow`
+ * @depth: the number of levels to expand
+ *
+ * Expands @self and its descendants up to @depth levels below it.
+ *
+ * A @depth of 1 is equivalent to calling
+ * [method@Gtk.TreeListRow.set_expanded], a @depth of `G_MAXUINT`
+ * expands the whole subtree. Rows that are already expanded stay
+ * expanded.
+ *
+ * Unlike expanding rows one by one, the model emits a single
+ * [signal@Gio.ListModel::items-changed] signal that replaces all
+ * children of @self.
+ *
+ * Since: 4.22
+ */
+void
+gtk_tree_list_row_expand_to_depth (GtkTreeListRow *self,
+                                   guint           depth)
+{
+  GtkTreeListModel *list;
+  GPtrArray *expanded_rows;
+  guint i, n_before, n_after;
+
+  g_return_if_fail (GTK_IS_TREE_LIST_ROW (self));
+
+  if (self->node == NULL || depth == 0)
+    return;
+
+  list = tree_node_get_tree_list_model (self->node);
+  if (list == NULL)
+    return;
+
+  expanded_rows = g_ptr_array_new_with_free_func (g_object_unref);
+
+  n_before = tree_node_get_n_children (self->node);
+  gtk_tree_list_model_expand_node_to_depth (list, self->node, depth, expanded_rows);
+  n_after = tree_node_get_n_children (self->node);
+
+  if (n_before != n_after)
+    {
+      g_list_model_items_changed (G_LIST_MODEL (list), tree_node_get_position (self->node) + 1, n_before, n_after);
+      g_object_notify_by_pspec (G_OBJECT (list), properties[PROP_N_ITEMS]);
+    }
+
+  for (i = 0; i < expanded_rows->len; i++)
+    {
+      GtkTreeListRow *row = g_ptr_array_index (expanded_rows, i);
+
+      g_object_notify_by_pspec (G_OBJECT (row), row_properties[ROW_PROP_EXPANDED]);
+      g_object_notify_by_pspec (G_OBJECT (row), row_properties[ROW_PROP_CHILDREN]);
+    }
+
+  g_ptr_array_unref (expanded_rows);
+}
+
 /**
  * gtk_tree_list_row_get_expanded:
  * @self: a `GtkTreeListRow`
@@ -86,6 +86,9 @@ gpointer                gtk_tree_list_row_get_item              (GtkTreeListRow
 GDK_AVAILABLE_IN_ALL
 void                    gtk_tree_list_row_set_expanded          (GtkTreeListRow         *self,
                                                                  gboolean                expanded);
+GDK_AVAILABLE_IN_4_22
+void                    gtk_tree_list_row_expand_to_depth       (GtkTreeListRow         *self,
+                                                                 guint                   depth);
 GDK_AVAILABLE_IN_ALL
 gboolean                gtk_tree_list_row_get_expanded          (GtkTreeListRow         *self);
 GDK_AVAILABLE_IN_ALL
@@ -0,0 +1,703 @@
+#include <gtk/gtk.h>
+
+#include "gtk/a11y/gtkatspicontextprivate.h"
+#include "gtk/a11y/gtkatspirootprivate.h"
+
+#ifdef GDK_WINDOWING_X11
+#include <gdk/x11/gdkx.h>
+#endif
+
+#ifdef GDK_WINDOWING_WAYLAND
+#include <gdk/wayland/gdkwayland.h>
+#endif
+
+/* These tests run the application against a private bus, with a fake
+ * registry that listens to all events, and count the signals that
+ * make it to the bus.
+ */
+
+#define ATSPI_ROOT_PATH     "/org/a11y/atspi/accessible/root"
+#define ATSPI_CACHE_PATH    "/org/a11y/atspi/cache"
+#define ATSPI_REGISTRY_PATH "/org/a11y/atspi/registry"
+
+static const char registry_xml[] =
+  "<node>"
+  "  <interface name='org.a11y.atspi.Socket'>"
+  "    <method name='Embed'>"
+  "      <arg type='(so)' direction='in'/>"
+  "      <arg type='(so)' direction='out'/>"
+  "    </method>"
+  "  </interface>"
+  "  <interface name='org.a11y.atspi.Registry'>"
+  "    <method name='GetRegisteredEvents'>"
+  "      <arg type='a(ss)' direction='out'/>"
+  "    </method>"
+  "  </interface>"
+  "</node>";
+
+static struct {
+  GTestDBus *bus;
+  GDBusConnection *connection;
+  GDBusNodeInfo *info;
+
+  /* The unique name of the application */
+  char *app_name;
+
+  /* The paths of the objects the application told us about */
+  GHashTable *announced;
+
+  guint n_add_accessible;
+  guint n_remove_accessible;
+  guint n_children_added;
+
+  /* The object whose events we record */
+  char *watched_path;
+  GString *states;
+  guint n_bounds_changed;
+} registry;
+
+static void
+reset_counters (void)
+{
+  registry.n_add_accessible = 0;
+  registry.n_remove_accessible = 0;
+  registry.n_children_added = 0;
+  registry.n_bounds_changed = 0;
+
+  if (registry.states != NULL)
+    g_string_truncate (registry.states, 0);
+}
+
+static void
+watch_object (const char *path)
+{
+  g_free (registry.watched_path);
+  registry.watched_path = g_strdup (path);
+
+  if (registry.states == NULL)
+    registry.states = g_string_new (NULL);
+}
+
+static void
+on_cache_signal (GDBusConnection *connection,
+                 const char      *sender_name,
+                 const char      *object_path,
+                 const char      *interface_name,
+                 const char      *signal_name,
+                 GVariant        *parameters,
+                 gpointer         user_data)
+{
+  const char *path;
+
+  if (g_str_equal (signal_name, "AddAccessible"))
+    {
+      GVariant *item = g_variant_get_child_value (parameters, 0);
+
+      g_variant_get_child (item, 0, "(&s&o)", NULL, &path);
+      g_hash_table_add (registry.announced, g_strdup (path));
+      registry.n_add_accessible++;
+
+      g_variant_unref (item);
+    }
+  else if (g_str_equal (signal_name, "RemoveAccessible"))
+    {
+      g_variant_get (parameters, "((&s&o))", NULL, &path);
+      g_hash_table_remove (registry.announced, path);
+      registry.n_remove_accessible++;
+    }
+}
+
+static void
+on_object_signal (GDBusConnection *connection,
+                  const char      *sender_name,
+                  const char      *object_path,
+                  const char      *interface_name,
+                  const char      *signal_name,
+                  GVariant        *parameters,
+                  gpointer         user_data)
+{
+  if (g_str_equal (signal_name, "ChildrenChanged"))
+    {
+      const char *change, *path;
+      GVariant *child;
+
+      g_variant_get (parameters, "(&siiva{sv})", &change, NULL, NULL, &child, NULL);
+
+      if (g_str_equal (change, "add"))
+        {
+          /* ATs ignore children they don't know about */
+          g_variant_get (child, "(&s&o)", NULL, &path);
+          g_assert_true (g_hash_table_contains (registry.announced, path));
+          registry.n_children_added++;
+        }
+
+      g_variant_unref (child);
+    }
+  else if (g_strcmp0 (object_path, registry.watched_path) == 0)
+    {
+      g_assert_true (g_hash_table_contains (registry.announced, object_path));
+
+      if (g_str_equal (signal_name, "StateChanged"))
+        {
+          const char *name;
+          int enabled;
+
+          g_variant_get (parameters, "(&siiva{sv})", &name, &enabled, NULL, NULL, NULL);
+          g_string_append_printf (registry.states, "%s=%d;", name, enabled);
+        }
+      else if (g_str_equal (signal_name, "BoundsChanged"))
+        {
+          registry.n_bounds_changed++;
+        }
+    }
+}
+
+static void
+handle_registry_method (GDBusConnection       *connection,
+                        const char            *sender,
+                        const char            *object_path,
+                        const char            *interface_name,
+                        const char            *method_name,
+                        GVariant              *parameters,
+                        GDBusMethodInvocation *invocation,
+                        gpointer               user_data)
+{
+  const char *unique_name = g_dbus_connection_get_unique_name (connection);
+
+  if (g_str_equal (method_name, "Embed"))
+    {
+      const char *app_name;
+
+      g_variant_get (parameters, "((&s&o))", &app_name, NULL);
+      g_free (registry.app_name);
+      registry.app_name = g_strdup (app_name);
+
+      g_dbus_method_invocation_return_value (invocation,
+                                             g_variant_new ("((so))", unique_name, ATSPI_ROOT_PATH));
+    }
+  else if (g_str_equal (method_name, "GetRegisteredEvents"))
+    {
+      GVariantBuilder builder = G_VARIANT_BUILDER_INIT (G_VARIANT_TYPE ("a(ss)"));
+
+      /* Listen to everything */
+      g_variant_builder_add (&builder, "(ss)", unique_name, "");
+
+      g_dbus_method_invocation_return_value (invocation,
+                                             g_variant_new ("(@a(ss))", g_variant_builder_end (&builder)));
+    }
+}
+
+static const GDBusInterfaceVTable registry_vtable = {
+  handle_registry_method,
+  NULL,
+  NULL,
+};
+
+static void
+registry_up (void)
+{
+  GVariant *reply;
+  guint32 result;
+  GError *error = NULL;
+
+  registry.bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (registry.bus);
+
+  registry.connection =
+    g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (registry.bus),
+                                            G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                            G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                            NULL, NULL,
+                                            &error);
+  g_assert_no_error (error);
+
+  registry.announced = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  g_dbus_connection_signal_subscribe (registry.connection,
+                                      NULL,
+                                      "org.a11y.atspi.Cache",
+                                      NULL,
+                                      ATSPI_CACHE_PATH,
+                                      NULL,
+                                      G_DBUS_SIGNAL_FLAGS_NONE,
+                                      on_cache_signal,
+                                      NULL, NULL);
+  g_dbus_connection_signal_subscribe (registry.connection,
+                                      NULL,
+                                      "org.a11y.atspi.Event.Object",
+                                      NULL,
+                                      NULL,
+                                      NULL,
+                                      G_DBUS_SIGNAL_FLAGS_NONE,
+                                      on_object_signal,
+                                      NULL, NULL);
+
+  registry.info = g_dbus_node_info_new_for_xml (registry_xml, &error);
+  g_assert_no_error (error);
+
+  g_dbus_connection_register_object (registry.connection,
+                                     ATSPI_ROOT_PATH,
+                                     g_dbus_node_info_lookup_interface (registry.info, "org.a11y.atspi.Socket"),
+                                     &registry_vtable,
+                                     NULL, NULL,
+                                     &error);
+  g_assert_no_error (error);
+  g_dbus_connection_register_object (registry.connection,
+                                     ATSPI_REGISTRY_PATH,
+                                     g_dbus_node_info_lookup_interface (registry.info, "org.a11y.atspi.Registry"),
+                                     &registry_vtable,
+                                     NULL, NULL,
+                                     &error);
+  g_assert_no_error (error);
+
+  /* DBUS_NAME_FLAG_DO_NOT_QUEUE */
+  reply = g_dbus_connection_call_sync (registry.connection,
+                                       "org.freedesktop.DBus",
+                                       "/org/freedesktop/DBus",
+                                       "org.freedesktop.DBus",
+                                       "RequestName",
+                                       g_variant_new ("(su)", "org.a11y.atspi.Registry", 4),
+                                       G_VARIANT_TYPE ("(u)"),
+                                       G_DBUS_CALL_FLAGS_NONE,
+                                       -1,
+                                       NULL,
+                                       &error);
+  g_assert_no_error (error);
+
+  /* DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER */
+  g_variant_get (reply, "(u)", &result);
+  g_assert_cmpuint (result, ==, 1);
+  g_variant_unref (reply);
+}
+
+static void
+registry_down (void)
+{
+  g_clear_pointer (&registry.announced, g_hash_table_unref);
+  g_clear_pointer (&registry.info, g_dbus_node_info_unref);
+  g_clear_pointer (&registry.app_name, g_free);
+  g_clear_pointer (&registry.watched_path, g_free);
+  if (registry.states != NULL)
+    g_string_free (registry.states, TRUE);
+  g_dbus_connection_close_sync (registry.connection, NULL, NULL);
+  g_clear_object (&registry.connection);
+
+  g_test_dbus_down (registry.bus);
+  g_clear_object (&registry.bus);
+}
+
+static void
+store_reply (GObject      *source,
+             GAsyncResult *result,
+             gpointer      data)
+{
+  GVariant **reply = data;
+  GError *error = NULL;
+
+  *reply = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+  g_assert_no_error (error);
+}
+
+static GVariant *
+call_app (const char         *path,
+          const char         *interface,
+          const char         *method,
+          GVariant           *parameters,
+          const GVariantType *reply_type)
+{
+  GVariant *reply = NULL;
+
+  /* The application handles the call in its main context, which
+   * is ours, so we can't block
+   */
+  g_dbus_connection_call (registry.connection,
+                          registry.app_name,
+                          path,
+                          interface,
+                          method,
+                          parameters,
+                          reply_type,
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          store_reply,
+                          &reply);
+
+  while (reply == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  return reply;
+}
+
+/* Runs the idles of the application, and waits for the signals
+ * they emitted to reach the registry
+ */
+static void
+flush_signals (void)
+{
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+
+  /* The application answers from its main context, after emitting
+   * everything that was pending, so the reply arrives last
+   */
+  g_variant_unref (call_app (ATSPI_ROOT_PATH,
+                             "org.freedesktop.DBus.Properties",
+                             "Get",
+                             g_variant_new ("(ss)", "org.a11y.atspi.Application", "ToolkitName"),
+                             G_VARIANT_TYPE ("(v)")));
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+/* Presents a window, and waits until the application is registered
+ * and knows that we are listening
+ */
+static GtkWidget *
+create_window (GtkWidget *child)
+{
+  GtkWidget *window;
+  GtkATContext *context;
+  GtkAtSpiRoot *root;
+
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), child);
+  gtk_window_present (GTK_WINDOW (window));
+
+  context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (window));
+  g_assert_true (GTK_IS_AT_SPI_CONTEXT (context));
+  root = gtk_at_spi_context_get_root (GTK_AT_SPI_CONTEXT (context));
+
+  while (gtk_at_spi_root_get_cache (root) == NULL ||
+         !gtk_at_spi_root_has_event_listeners (root))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_object_unref (context);
+
+  flush_signals ();
+
+  return window;
+}
+
+static char *
+get_context_path (GtkWidget *widget)
+{
+  GtkATContext *context;
+  char *path;
+
+  context = gtk_accessible_get_at_context (GTK_ACCESSIBLE (widget));
+  path = g_strdup (gtk_at_spi_context_get_context_path (GTK_AT_SPI_CONTEXT (context)));
+  g_object_unref (context);
+
+  g_assert_nonnull (path);
+
+  return path;
+}
+
+static GtkWidget *
+create_label (gpointer item,
+              gpointer user_data)
+{
+  return gtk_label_new (gtk_string_object_get_string (item));
+}
+
+static void
+replace_items (GListStore *store,
+               guint       n_items,
+               const char *prefix)
+{
+  GtkStringObject **items;
+  guint i;
+
+  items = g_new (GtkStringObject *, n_items);
+  for (i = 0; i < n_items; i++)
+    {
+      char *string = g_strdup_printf ("%s%u", prefix, i);
+      items[i] = gtk_string_object_new (string);
+      g_free (string);
+    }
+
+  g_list_store_splice (store, 0, g_list_model_get_n_items (G_LIST_MODEL (store)),
+                       (gpointer *) items, n_items);
+
+  for (i = 0; i < n_items; i++)
+    g_object_unref (items[i]);
+  g_free (items);
+}
+
+static gboolean
+block_idles (gpointer data)
+{
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+test_cache_list_rebuild (void)
+{
+  GtkWidget *window, *list;
+  GListStore *store;
+  guint n_announced;
+
+  g_test_summary ("Rows that are replaced in the same main loop iteration "
+                  "are never announced to ATs");
+
+  if (registry.bus == NULL)
+    {
+      g_test_skip ("No accessibility bus");
+      return;
+    }
+
+  store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  list = gtk_list_box_new ();
+  gtk_list_box_bind_model (GTK_LIST_BOX (list), G_LIST_MODEL (store), create_label, NULL, NULL);
+  window = create_window (list);
+
+  reset_counters ();
+  replace_items (store, 10, "a");
+  flush_signals ();
+
+  n_announced = registry.n_add_accessible;
+  g_assert_cmpuint (n_announced, >=, 10);
+  g_assert_cmpuint (registry.n_remove_accessible, ==, 0);
+  g_assert_cmpuint (registry.n_children_added, >=, 10);
+
+  /* Rebuild the list twice; only the rows of the last rebuild
+   * make it to the bus, and the old ones are retracted
+   */
+  reset_counters ();
+  replace_items (store, 10, "b");
+  replace_items (store, 10, "c");
+  flush_signals ();
+
+  g_assert_cmpuint (registry.n_add_accessible, ==, n_announced);
+  g_assert_cmpuint (registry.n_remove_accessible, ==, n_announced);
+  g_assert_cmpuint (registry.n_children_added, >=, 10);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (store);
+  flush_signals ();
+}
+
+static void
+test_cache_get_items (void)
+{
+  GtkWidget *window, *list, *row;
+  GListStore *store;
+  GVariant *reply, *items;
+  char *row_path;
+  guint blocker;
+  gsize i;
+
+  g_test_summary ("Objects returned by GetItems are not announced again, "
+                  "and are retracted when they go away");
+
+  if (registry.bus == NULL)
+    {
+      g_test_skip ("No accessibility bus");
+      return;
+    }
+
+  store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  list = gtk_list_box_new ();
+  gtk_list_box_bind_model (GTK_LIST_BOX (list), G_LIST_MODEL (store), create_label, NULL, NULL);
+  window = create_window (list);
+
+  /* Keep the application from announcing the row on its own */
+  blocker = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE - 1, block_idles, NULL, NULL);
+
+  reset_counters ();
+  replace_items (store, 1, "a");
+  row = GTK_WIDGET (gtk_list_box_get_row_at_index (GTK_LIST_BOX (list), 0));
+  row_path = get_context_path (row);
+  g_assert_false (g_hash_table_contains (registry.announced, row_path));
+
+  /* Do what an AT does when it starts */
+  reply = call_app (ATSPI_CACHE_PATH,
+                    "org.a11y.atspi.Cache",
+                    "GetItems",
+                    NULL,
+                    G_VARIANT_TYPE ("(a((so)(so)(so)iiassusau))"));
+  items = g_variant_get_child_value (reply, 0);
+  for (i = 0; i < g_variant_n_children (items); i++)
+    {
+      GVariant *item = g_variant_get_child_value (items, i);
+      const char *path;
+
+      g_variant_get_child (item, 0, "(&s&o)", NULL, &path);
+      g_hash_table_add (registry.announced, g_strdup (path));
+
+      g_variant_unref (item);
+    }
+  g_variant_unref (items);
+  g_variant_unref (reply);
+
+  g_assert_true (g_hash_table_contains (registry.announced, row_path));
+
+  /* Drop the row before the application gets to announce it */
+  g_list_store_remove_all (store);
+
+  g_source_remove (blocker);
+  flush_signals ();
+
+  g_assert_cmpuint (registry.n_add_accessible, ==, 0);
+  g_assert_cmpuint (registry.n_remove_accessible, >=, 1);
+  g_assert_false (g_hash_table_contains (registry.announced, row_path));
+
+  g_free (row_path);
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (store);
+  flush_signals ();
+}
+
+static void
+test_events_bounds (void)
+{
+  GtkWidget *window, *box, *button;
+  char *path;
+  int i;
+
+  g_test_summary ("A relayout that resizes an object many times "
+                  "only emits a single BoundsChanged signal");
+
+  if (registry.bus == NULL)
+    {
+      g_test_skip ("No accessibility bus");
+      return;
+    }
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  button = gtk_button_new_with_label ("Button");
+  gtk_box_append (GTK_BOX (box), button);
+  window = create_window (box);
+
+  path = get_context_path (button);
+  watch_object (path);
+  reset_counters ();
+
+  for (i = 1; i <= 3; i++)
+    gtk_widget_size_allocate (button, &(GtkAllocation) { 0, 0, 100 * i, 50 * i }, -1);
+
+  flush_signals ();
+
+  g_assert_cmpuint (registry.n_bounds_changed, ==, 1);
+
+  watch_object (NULL);
+  g_free (path);
+  gtk_window_destroy (GTK_WINDOW (window));
+  flush_signals ();
+}
+
+static void
+test_events_state (void)
+{
+  GtkWidget *window, *box, *button;
+  char *path;
+
+  g_test_summary ("Redundant StateChanged signals are skipped, but states "
+                  "that are toggled back and forth reach the bus");
+
+  if (registry.bus == NULL)
+    {
+      g_test_skip ("No accessibility bus");
+      return;
+    }
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  button = gtk_toggle_button_new_with_label ("Button");
+  /* Keep focus changes out of the recorded states */
+  gtk_widget_set_focusable (button, FALSE);
+  gtk_box_append (GTK_BOX (box), button);
+  window = create_window (box);
+
+  path = get_context_path (button);
+  watch_object (path);
+  reset_counters ();
+
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), TRUE);
+  flush_signals ();
+
+  g_assert_cmpstr (registry.states->str, ==, "pressed=1;indeterminate=0;");
+
+  /* Nothing is pending, the toggles happen in the same iteration */
+  reset_counters ();
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), FALSE);
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), TRUE);
+  flush_signals ();
+
+  g_assert_cmpstr (registry.states->str, ==, "pressed=0;pressed=1;");
+  g_free (path);
+
+  /* A new button, whose announcement is still pending */
+  button = gtk_toggle_button_new_with_label ("Other button");
+  gtk_widget_set_focusable (button, FALSE);
+  gtk_box_append (GTK_BOX (box), button);
+
+  path = get_context_path (button);
+  watch_object (path);
+  reset_counters ();
+
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), TRUE);
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), FALSE);
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), TRUE);
+  flush_signals ();
+
+  g_assert_true (g_hash_table_contains (registry.announced, path));
+  g_assert_cmpstr (registry.states->str, ==, "pressed=1;indeterminate=0;pressed=0;pressed=1;");
+
+  watch_object (NULL);
+  g_free (path);
+  gtk_window_destroy (GTK_WINDOW (window));
+  flush_signals ();
+}
+
+static gboolean
+has_atspi_display (void)
+{
+  GdkDisplay *display = gdk_display_get_default ();
+
+#ifdef GDK_WINDOWING_X11
+  if (GDK_IS_X11_DISPLAY (display))
+    return TRUE;
+#endif
+#ifdef GDK_WINDOWING_WAYLAND
+  if (GDK_IS_WAYLAND_DISPLAY (display))
+    return TRUE;
+#endif
+
+  return FALSE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  char *dbus_daemon;
+  int result;
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  /* The display is already open, so we don't mind g_test_dbus_up()
+   * clearing DISPLAY and friends
+   */
+  dbus_daemon = g_find_program_in_path ("dbus-daemon");
+  if (dbus_daemon != NULL && has_atspi_display ())
+    {
+      registry_up ();
+
+      g_setenv ("AT_SPI_BUS_ADDRESS", g_test_dbus_get_bus_address (registry.bus), TRUE);
+      g_setenv ("GTK_A11Y", "atspi", TRUE);
+    }
+  g_free (dbus_daemon);
+
+  g_test_add_func ("/a11y/atspi/cache/list-rebuild", test_cache_list_rebuild);
+  g_test_add_func ("/a11y/atspi/cache/get-items", test_cache_get_items);
+  g_test_add_func ("/a11y/atspi/events/bounds", test_events_bounds);
+  g_test_add_func ("/a11y/atspi/events/state", test_events_state);
+
+  result = g_test_run ();
+
+  if (registry.bus != NULL)
+    registry_down ();
+
+  return result;
+}
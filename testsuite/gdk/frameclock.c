@@ -0,0 +1,176 @@
+#include <gtk/gtk.h>
+
+#include "gdk/gdkdebugprivate.h"
+#include "gdk/gdkframeclockidleprivate.h"
+
+/* same as in gdkframeclockidle.c */
+#define FRAME_INTERVAL 16667 /* microseconds */
+
+typedef struct {
+  gint64 work;
+  guint n_paints;
+  gint64 paint_time;
+  gint64 frame_time;
+} FrameData;
+
+static void
+paint_cb (GdkFrameClock *clock,
+          FrameData     *data)
+{
+  data->paint_time = g_get_monotonic_time ();
+  data->frame_time = gdk_frame_clock_get_frame_time (clock);
+  data->n_paints++;
+
+  g_usleep (data->work);
+}
+
+/* Like the backends, freeze the clock until the next vblank */
+static void
+after_paint_cb (GdkFrameClock *clock,
+                FrameData     *data)
+{
+  _gdk_frame_clock_uninhibit_freeze (clock);
+}
+
+static GdkFrameClock *
+create_clock (FrameData *data)
+{
+  GdkFrameClock *clock;
+
+  clock = _gdk_frame_clock_idle_new ();
+  g_signal_connect (clock, "paint", G_CALLBACK (paint_cb), data);
+  g_signal_connect (clock, "after-paint", G_CALLBACK (after_paint_cb), data);
+
+  return clock;
+}
+
+/* Pretend a vblank happened and return how long it took to paint */
+static gint64
+run_frame (GdkFrameClock *clock,
+           FrameData     *data)
+{
+  guint n_paints = data->n_paints;
+  gint64 thaw_time;
+
+  g_assert_true (gdk_frame_clock_is_frozen (clock));
+
+  gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_PAINT);
+  thaw_time = g_get_monotonic_time ();
+  _gdk_frame_clock_inhibit_freeze (clock);
+
+  while (data->n_paints == n_paints)
+    g_main_context_iteration (NULL, TRUE);
+
+  return data->paint_time - thaw_time;
+}
+
+static void
+test_pacing_default (void)
+{
+  FrameData data = { 2000, };
+  GdkFrameClock *clock;
+  guint flags;
+  int i;
+
+  g_test_summary ("Frames start right after a thaw unless frame pacing is enabled");
+
+  flags = _gdk_debug_flags;
+  _gdk_debug_flags &= ~GDK_DEBUG_FRAME_PACING;
+
+  clock = create_clock (&data);
+
+  for (i = 0; i < 5; i++)
+    {
+      guint n_paints = data.n_paints;
+
+      gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_PAINT);
+      _gdk_frame_clock_inhibit_freeze (clock);
+
+      /* the paint must not wait for a timeout */
+      while (g_main_context_iteration (NULL, FALSE));
+      g_assert_cmpuint (data.n_paints, ==, n_paints + 1);
+    }
+
+  g_object_unref (clock);
+
+  _gdk_debug_flags = flags;
+}
+
+static void
+test_pacing_delay (void)
+{
+  FrameData data = { 2000, };
+  GdkFrameClock *clock;
+  guint flags;
+  int i;
+
+  g_test_summary ("With frame pacing, frames get delayed after a thaw");
+
+  flags = _gdk_debug_flags;
+  _gdk_debug_flags |= GDK_DEBUG_FRAME_PACING;
+
+  clock = create_clock (&data);
+
+  /* no estimate for the first frame yet */
+  run_frame (clock, &data);
+
+  for (i = 0; i < 3; i++)
+    {
+      /* The delay is capped at half a frame, and the estimate
+       * starts at 2ms, so we wait ~8ms. Timeouts never fire
+       * early, so the lower bound is safe. */
+      g_assert_cmpint (run_frame (clock, &data), >=, FRAME_INTERVAL / 4);
+    }
+
+  g_object_unref (clock);
+
+  _gdk_debug_flags = flags;
+}
+
+static void
+test_pacing_frame_time (void)
+{
+  FrameData data = { 2000, };
+  GdkFrameClock *clock;
+  gint64 first_frame_time;
+  guint flags;
+  int i;
+
+  g_test_summary ("Delayed frames don't align the frame time to the time they started");
+
+  flags = _gdk_debug_flags;
+  _gdk_debug_flags |= GDK_DEBUG_FRAME_PACING;
+
+  clock = create_clock (&data);
+
+  run_frame (clock, &data);
+  first_frame_time = data.frame_time;
+
+  for (i = 0; i < 5; i++)
+    {
+      gint64 previous_frame_time = data.frame_time;
+
+      run_frame (clock, &data);
+
+      /* Without a vsync-related start time, the frame time advances
+       * in whole frames */
+      g_assert_cmpint (data.frame_time, >=, previous_frame_time);
+      g_assert_cmpint ((data.frame_time - first_frame_time) % FRAME_INTERVAL, ==, 0);
+    }
+
+  g_object_unref (clock);
+
+  _gdk_debug_flags = flags;
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/frameclock/pacing/default", test_pacing_default);
+  g_test_add_func ("/frameclock/pacing/delay", test_pacing_delay);
+  g_test_add_func ("/frameclock/pacing/frame-time", test_pacing_frame_time);
+
+  return g_test_run ();
+}
@@ -117,6 +117,43 @@ test_save_image (gconstpointer test_data)
   g_free (path);
 }
 
+static void
+test_save_png_to_stream (void)
+{
+  char *path;
+  GdkTexture *texture;
+  GdkTexture *texture2;
+  GOutputStream *stream;
+  GBytes *bytes;
+  GBytes *bytes2;
+  GError *error = NULL;
+
+  path = g_test_build_filename (G_TEST_DIST, "image-data", "image.png", NULL);
+  texture = gdk_texture_new_from_filename (path, &error);
+  g_assert_no_error (error);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert_true (gdk_save_png_to_stream (texture, NULL, stream, NULL, &error));
+  g_assert_no_error (error);
+  g_output_stream_close (stream, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+  bytes2 = gdk_save_png (texture, NULL);
+  g_assert_true (g_bytes_equal (bytes, bytes2));
+
+  texture2 = gdk_texture_new_from_bytes (bytes, &error);
+  g_assert_no_error (error);
+  assert_texture_equal (texture, texture2);
+
+  g_object_unref (texture2);
+  g_bytes_unref (bytes2);
+  g_bytes_unref (bytes);
+  g_object_unref (stream);
+  g_object_unref (texture);
+  g_free (path);
+}
+
 static void
 test_load_image_fail (gconstpointer data)
 {
@@ -176,6 +213,7 @@ main (int argc, char *argv[])
   g_test_add_data_func ("/image/save/image.png", "image.png", test_save_image);
   g_test_add_data_func ("/image/save/image.tiff", "image.tiff", test_save_image);
   g_test_add_data_func ("/image/save/image.jpeg", "image.jpeg", test_save_image);
+  g_test_add_func ("/image/save/png-stream", test_save_png_to_stream);
 
   return g_test_run ();
 }
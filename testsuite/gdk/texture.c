@@ -459,6 +459,58 @@ test_texture_downloader (void)
   g_object_unref (texture);
 }
 
+static void
+download_bytes_done (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      data)
+{
+  GBytes **bytes = data;
+  GdkTextureDownloader *downloader;
+  GError *error = NULL;
+  gsize stride;
+
+  g_assert_true (GDK_IS_TEXTURE (source));
+
+  downloader = gdk_texture_downloader_new (GDK_TEXTURE (source));
+  *bytes = gdk_texture_downloader_download_bytes_finish (downloader, result, &stride, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (stride, ==, 4 * 2 * gdk_texture_get_width (GDK_TEXTURE (source)));
+  gdk_texture_downloader_free (downloader);
+
+  g_main_context_wakeup (NULL);
+}
+
+static void
+test_texture_downloader_async (void)
+{
+  GdkTexture *texture;
+  GdkTextureDownloader *downloader;
+  GBytes *bytes;
+  GBytes *async_bytes = NULL;
+  gsize stride;
+
+  texture = gdk_texture_new_from_resource ("/org/gtk/libgdk/cursor/text");
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, GDK_MEMORY_R16G16B16A16);
+
+  gdk_texture_downloader_download_bytes_async (downloader, NULL, download_bytes_done, &async_bytes);
+  /* changing settings must not affect the running download */
+  gdk_texture_downloader_set_format (downloader, GDK_MEMORY_A8);
+
+  while (async_bytes == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  gdk_texture_downloader_set_format (downloader, GDK_MEMORY_R16G16B16A16);
+  bytes = gdk_texture_downloader_download_bytes (downloader, &stride);
+  g_assert_true (g_bytes_equal (bytes, async_bytes));
+
+  g_bytes_unref (async_bytes);
+  g_bytes_unref (bytes);
+  gdk_texture_downloader_free (downloader);
+  g_object_unref (texture);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -475,6 +527,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/texture/icon/serialize", test_texture_icon_serialize);
   g_test_add_func ("/texture/diff", test_texture_diff);
   g_test_add_func ("/texture/downloader", test_texture_downloader);
+  g_test_add_func ("/texture/downloader-async", test_texture_downloader_async);
 
   return g_test_run ();
 }
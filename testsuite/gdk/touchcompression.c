@@ -0,0 +1,196 @@
+#include <gtk/gtk.h>
+
+#include "gdk/gdkdisplayprivate.h"
+#include "gdk/gdkeventsprivate.h"
+
+#define SEQUENCE_A ((GdkEventSequence *) GUINT_TO_POINTER (1))
+#define SEQUENCE_B ((GdkEventSequence *) GUINT_TO_POINTER (2))
+
+typedef struct {
+  GdkDisplay *display;
+  GdkSurface *surface;
+  GdkDevice *device;
+  guint n_queued;
+} Fixture;
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+  fixture->display = gdk_display_get_default ();
+  fixture->surface = gdk_surface_new_toplevel (fixture->display);
+  fixture->device = gdk_seat_get_pointer (gdk_display_get_default_seat (fixture->display));
+  fixture->n_queued = g_queue_get_length (&fixture->display->queued_events);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+  /* Drop whatever the test left in the queue */
+  while (g_queue_get_length (&fixture->display->queued_events) > fixture->n_queued)
+    gdk_event_unref (g_queue_pop_tail (&fixture->display->queued_events));
+
+  gdk_surface_destroy (fixture->surface);
+  g_object_unref (fixture->surface);
+}
+
+static void
+queue_touch (Fixture          *fixture,
+             GdkEventType      type,
+             GdkEventSequence *sequence,
+             guint32           time,
+             double            x)
+{
+  GdkEvent *event;
+
+  event = gdk_touch_event_new (type,
+                               sequence,
+                               fixture->surface,
+                               fixture->device,
+                               time,
+                               0,
+                               x, 2 * x,
+                               NULL,
+                               FALSE);
+
+  _gdk_event_queue_append (fixture->display, event);
+}
+
+/* Returns the n-th event that the test queued */
+static GdkEvent *
+get_queued (Fixture *fixture,
+            guint    n)
+{
+  return g_queue_peek_nth (&fixture->display->queued_events, fixture->n_queued + n);
+}
+
+static guint
+get_n_queued (Fixture *fixture)
+{
+  return g_queue_get_length (&fixture->display->queued_events) - fixture->n_queued;
+}
+
+static void
+assert_touch (GdkEvent         *event,
+              GdkEventType      type,
+              GdkEventSequence *sequence,
+              guint32           time,
+              double            x)
+{
+  double ex, ey;
+
+  g_assert_cmpint (gdk_event_get_event_type (event), ==, type);
+  g_assert_true (gdk_event_get_event_sequence (event) == sequence);
+  g_assert_cmpuint (gdk_event_get_time (event), ==, time);
+  g_assert_true (gdk_event_get_position (event, &ex, &ey));
+  g_assert_cmpfloat (ex, ==, x);
+  g_assert_cmpfloat (ey, ==, 2 * x);
+}
+
+static void
+assert_history (GdkEvent      *event,
+                guint          n_expected,
+                const guint32 *times)
+{
+  GdkTimeCoord *history;
+  guint i, n_coords;
+
+  history = gdk_event_get_history (event, &n_coords);
+
+  if (n_expected == 0)
+    {
+      g_assert_null (history);
+      return;
+    }
+
+  g_assert_nonnull (history);
+  g_assert_cmpuint (n_coords, ==, n_expected);
+
+  /* We use the time as the x coordinate */
+  for (i = 0; i < n_coords; i++)
+    {
+      g_assert_cmpuint (history[i].time, ==, times[i]);
+      g_assert_true (history[i].flags & GDK_AXIS_FLAG_X);
+      g_assert_true (history[i].flags & GDK_AXIS_FLAG_Y);
+      g_assert_cmpfloat (history[i].axes[GDK_AXIS_X], ==, times[i]);
+      g_assert_cmpfloat (history[i].axes[GDK_AXIS_Y], ==, 2 * times[i]);
+    }
+
+  g_free (history);
+}
+
+static void
+test_single_sequence (Fixture       *fixture,
+                      gconstpointer  data)
+{
+  guint32 i;
+
+  g_test_summary ("Touch updates for one sequence get merged, keeping history");
+
+  for (i = 1; i <= 4; i++)
+    queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, i, i);
+
+  gdk_event_queue_handle_touch_compression (fixture->display);
+
+  g_assert_cmpuint (get_n_queued (fixture), ==, 1);
+  assert_touch (get_queued (fixture, 0), GDK_TOUCH_UPDATE, SEQUENCE_A, 4, 4);
+  assert_history (get_queued (fixture, 0), 3, (guint32[]) { 1, 2, 3 });
+}
+
+static void
+test_interleaved_sequences (Fixture       *fixture,
+                            gconstpointer  data)
+{
+  g_test_summary ("Interleaved touch updates are only merged within their own sequence");
+
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, 1, 1);
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_B, 2, 2);
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, 3, 3);
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_B, 4, 4);
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, 5, 5);
+
+  gdk_event_queue_handle_touch_compression (fixture->display);
+
+  g_assert_cmpuint (get_n_queued (fixture), ==, 2);
+  assert_touch (get_queued (fixture, 0), GDK_TOUCH_UPDATE, SEQUENCE_B, 4, 4);
+  assert_history (get_queued (fixture, 0), 1, (guint32[]) { 2 });
+  assert_touch (get_queued (fixture, 1), GDK_TOUCH_UPDATE, SEQUENCE_A, 5, 5);
+  assert_history (get_queued (fixture, 1), 2, (guint32[]) { 1, 3 });
+}
+
+static void
+test_other_events (Fixture       *fixture,
+                   gconstpointer  data)
+{
+  g_test_summary ("Touch updates are not merged across other events");
+
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, 1, 1);
+  queue_touch (fixture, GDK_TOUCH_BEGIN, SEQUENCE_B, 2, 2);
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, 3, 3);
+  queue_touch (fixture, GDK_TOUCH_UPDATE, SEQUENCE_A, 4, 4);
+
+  gdk_event_queue_handle_touch_compression (fixture->display);
+
+  g_assert_cmpuint (get_n_queued (fixture), ==, 3);
+  assert_touch (get_queued (fixture, 0), GDK_TOUCH_UPDATE, SEQUENCE_A, 1, 1);
+  assert_history (get_queued (fixture, 0), 0, NULL);
+  assert_touch (get_queued (fixture, 1), GDK_TOUCH_BEGIN, SEQUENCE_B, 2, 2);
+  assert_touch (get_queued (fixture, 2), GDK_TOUCH_UPDATE, SEQUENCE_A, 4, 4);
+  assert_history (get_queued (fixture, 2), 1, (guint32[]) { 3 });
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/touch-compression/single-sequence", Fixture, NULL,
+              fixture_setup, test_single_sequence, fixture_teardown);
+  g_test_add ("/touch-compression/interleaved-sequences", Fixture, NULL,
+              fixture_setup, test_interleaved_sequences, fixture_teardown);
+  g_test_add ("/touch-compression/other-events", Fixture, NULL,
+              fixture_setup, test_other_events, fixture_teardown);
+
+  return g_test_run ();
+}
@@ -0,0 +1,211 @@
+#include "config.h"
+
+#include <gtk/gtk.h>
+
+#include "gsk/gpu/gskgpurendererprivate.h"
+
+/* Large blurs are done at reduced resolution by the GPU renderers.
+ * Check that the result stays close to a full resolution blur.
+ */
+
+/* The source has stripes 2 pixels wide, every 4 pixels. If the
+ * downscaled blur skipped rows or columns, it would only see one
+ * of the colors, and the result would be off by up to 50%.
+ */
+#define STRIPE_PERIOD 4
+#define SIZE 256
+#define BLUR_RADIUS 100 /* way above the downscale threshold */
+#define TOLERANCE 10 /* out of 255 */
+
+struct {
+  const char *name;
+  GType (* get_type) (void);
+  GskRenderer *renderer;
+  GskRenderer *full_renderer;
+} renderers[] = {
+  {
+    "vulkan",
+    gsk_vulkan_renderer_get_type,
+  },
+  {
+    "gl",
+    gsk_gl_renderer_get_type,
+  },
+};
+
+static GdkTexture *
+create_stripes_texture (void)
+{
+  GdkTexture *texture;
+  GBytes *bytes;
+  guchar *data;
+  int x, y;
+
+  data = g_malloc (SIZE * SIZE * 4);
+
+  for (y = 0; y < SIZE; y++)
+    for (x = 0; x < SIZE; x++)
+      {
+        guchar *pixel = data + 4 * (y * SIZE + x);
+
+        pixel[0] = (x % STRIPE_PERIOD == 1 || x % STRIPE_PERIOD == 2) ? 255 : 0;
+        pixel[1] = (y % STRIPE_PERIOD == 1 || y % STRIPE_PERIOD == 2) ? 255 : 0;
+        pixel[2] = 0;
+        pixel[3] = 255;
+      }
+
+  bytes = g_bytes_new_take (data, SIZE * SIZE * 4);
+  texture = gdk_memory_texture_new (SIZE, SIZE, GDK_MEMORY_R8G8B8A8, bytes, SIZE * 4);
+  g_bytes_unref (bytes);
+
+  return texture;
+}
+
+static guchar *
+download (GdkTexture *texture)
+{
+  gsize stride = gdk_texture_get_width (texture) * 4;
+  guchar *data;
+
+  data = g_malloc (stride * gdk_texture_get_height (texture));
+  gdk_texture_download (texture, data, stride);
+
+  return data;
+}
+
+static void
+test_blur_downscale (gconstpointer data)
+{
+  gsize idx = GPOINTER_TO_SIZE (data);
+  GskRenderNode *child, *node;
+  GdkTexture *texture, *downscaled, *full;
+  guchar *downscaled_data, *full_data;
+  gsize i, n_bytes;
+  guint max_error;
+
+  texture = create_stripes_texture ();
+  child = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (0, 0, SIZE, SIZE));
+  node = gsk_blur_node_new (child, BLUR_RADIUS);
+
+  downscaled = gsk_renderer_render_texture (renderers[idx].renderer, node, &child->bounds);
+  full = gsk_renderer_render_texture (renderers[idx].full_renderer, node, &child->bounds);
+
+  downscaled_data = download (downscaled);
+  full_data = download (full);
+
+  max_error = 0;
+  n_bytes = gdk_texture_get_width (full) * gdk_texture_get_height (full) * 4;
+  for (i = 0; i < n_bytes; i++)
+    max_error = MAX (max_error, ABS ((int) downscaled_data[i] - (int) full_data[i]));
+
+  g_test_message ("largest difference: %u", max_error);
+  g_assert_cmpuint (max_error, <=, TOLERANCE);
+
+  g_free (downscaled_data);
+  g_free (full_data);
+  g_object_unref (downscaled);
+  g_object_unref (full);
+  gsk_render_node_unref (node);
+  gsk_render_node_unref (child);
+  g_object_unref (texture);
+}
+
+static GskRenderer *
+create_renderer (GType    type,
+                 gboolean downscale)
+{
+  GskGpuRendererClass *klass;
+  GskGpuOptimizations optimizations;
+  GskRenderer *renderer;
+  GError *error = NULL;
+
+  /* The optimizations are copied from the class when creating
+   * the renderer, so we can toggle them per renderer.
+   */
+  klass = g_type_class_ref (type);
+  optimizations = klass->optimizations;
+  if (!downscale)
+    klass->optimizations &= ~GSK_GPU_OPTIMIZE_BLUR_DOWNSCALE;
+
+  renderer = g_object_new (type, NULL);
+
+  klass->optimizations = optimizations;
+  g_type_class_unref (klass);
+
+  if (!gsk_renderer_realize_for_display (renderer, gdk_display_get_default (), &error))
+    {
+      g_test_message ("Could not realize renderer: %s", error->message);
+      g_clear_error (&error);
+      g_clear_object (&renderer);
+    }
+
+  return renderer;
+}
+
+static void
+create_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      renderers[i].renderer = create_renderer (renderers[i].get_type (), TRUE);
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      renderers[i].full_renderer = create_renderer (renderers[i].get_type (), FALSE);
+      if (renderers[i].full_renderer == NULL)
+        {
+          gsk_renderer_unrealize (renderers[i].renderer);
+          g_clear_object (&renderers[i].renderer);
+        }
+    }
+}
+
+static void
+destroy_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+      gsk_renderer_unrealize (renderers[i].full_renderer);
+      g_clear_object (&renderers[i].full_renderer);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result;
+  gsize i;
+
+  gtk_test_init (&argc, &argv, NULL);
+  create_renderers ();
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      test_name = g_strdup_printf ("/blur-downscale/stripes/%s", renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), test_blur_downscale);
+      g_free (test_name);
+    }
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  destroy_renderers ();
+
+  return result;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2025 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+#include <math.h>
+#include "gsk/gskcairoblurprivate.h"
+
+/* A straightforward version of the box blur, with a division
+ * per pixel and columns done by transposing the buffer. This is
+ * what the Cairo renderer used to do, and the optimized code must
+ * produce the exact same results.
+ */
+static void
+reference_blur_span (guchar *row,
+                     guchar *tmp,
+                     int     width,
+                     int     d,
+                     int     shift)
+{
+  int offset, sum, i;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  sum = 0;
+  for (i = -d + offset; i < width + offset; i++)
+    {
+      if (i >= 0 && i < width)
+        sum += row[i];
+
+      if (i >= offset)
+        {
+          if (i >= d)
+            sum -= row[i - d];
+
+          tmp[i - offset] = (sum + d / 2) / d;
+        }
+    }
+
+  memcpy (row, tmp, width);
+}
+
+static void
+reference_blur_rows (guchar *buffer,
+                     int     width,
+                     int     height,
+                     int     d)
+{
+  guchar *tmp = g_malloc (width);
+  int y;
+
+  for (y = 0; y < height; y++)
+    {
+      guchar *row = buffer + y * width;
+
+      if (d % 2 == 1)
+        {
+          reference_blur_span (row, tmp, width, d, 0);
+          reference_blur_span (row, tmp, width, d, 0);
+          reference_blur_span (row, tmp, width, d, 0);
+        }
+      else
+        {
+          reference_blur_span (row, tmp, width, d, 1);
+          reference_blur_span (row, tmp, width, d, -1);
+          reference_blur_span (row, tmp, width, d + 1, 0);
+        }
+    }
+
+  g_free (tmp);
+}
+
+static void
+reference_transpose (guchar *dst,
+                     guchar *src,
+                     int     width,
+                     int     height)
+{
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      dst[x * height + y] = src[y * width + x];
+}
+
+static void
+reference_blur (guchar       *buffer,
+                int           width,
+                int           height,
+                int           radius,
+                GskBlurFlags  flags)
+{
+  int d = (int) ((3.0 * sqrt (2 * G_PI) / 4) * radius);
+
+  if (radius <= 1)
+    return;
+
+  if (flags & GSK_BLUR_Y)
+    {
+      guchar *flipped = g_malloc (width * height);
+
+      reference_transpose (flipped, buffer, width, height);
+      reference_blur_rows (flipped, height, width, d);
+      reference_transpose (buffer, flipped, height, width);
+
+      g_free (flipped);
+    }
+
+  if (flags & GSK_BLUR_X)
+    reference_blur_rows (buffer, width, height, d);
+}
+
+static void
+check_blur (int          width,
+            int          height,
+            double       radius,
+            GskBlurFlags flags)
+{
+  cairo_surface_t *surface;
+  guchar *data, *expected;
+  int x, y, stride;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+
+  /* Sharp edges and random noise, to catch rounding differences */
+  for (y = 0; y < height; y++)
+    for (x = 0; x < stride; x++)
+      {
+        if (g_test_rand_bit ())
+          data[y * stride + x] = g_test_rand_int_range (0, 256);
+        else
+          data[y * stride + x] = (x / 7 + y / 5) % 2 ? 255 : 0;
+      }
+  cairo_surface_mark_dirty (surface);
+
+  expected = g_memdup2 (data, stride * height);
+  reference_blur (expected, stride, height, radius, flags);
+
+  gsk_cairo_blur_surface (surface, radius, flags);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < stride; x++)
+        {
+          if (data[y * stride + x] != expected[y * stride + x])
+            {
+              g_test_message ("%dx%d, radius %g: pixel %d,%d is %u, expected %u",
+                              width, height, radius, x, y,
+                              data[y * stride + x], expected[y * stride + x]);
+              g_test_fail ();
+              goto out;
+            }
+        }
+    }
+
+out:
+  g_free (expected);
+  cairo_surface_destroy (surface);
+}
+
+static void
+test_blur_small (void)
+{
+  double radii[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (radii); i++)
+    {
+      check_blur (37, 23, radii[i], GSK_BLUR_X | GSK_BLUR_Y);
+      check_blur (37, 23, radii[i], GSK_BLUR_X);
+      check_blur (37, 23, radii[i], GSK_BLUR_Y);
+    }
+}
+
+static void
+test_blur_large (void)
+{
+  double radii[] = { 11, 17.5, 32, 50, 99, 200 };
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (radii); i++)
+    {
+      check_blur (301, 257, radii[i], GSK_BLUR_X | GSK_BLUR_Y);
+      check_blur (301, 257, radii[i], GSK_BLUR_Y);
+    }
+}
+
+static void
+test_blur_random (void)
+{
+  int i;
+
+  for (i = 0; i < 50; i++)
+    {
+      check_blur (g_test_rand_int_range (1, 400),
+                  g_test_rand_int_range (1, 400),
+                  g_test_rand_double_range (0, 100),
+                  g_test_rand_int_range (1, 4));
+    }
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/cairo-blur/small", test_blur_small);
+  g_test_add_func ("/cairo-blur/large", test_blur_large);
+  g_test_add_func ("/cairo-blur/random", test_blur_random);
+
+  return g_test_run ();
+}
@@ -344,34 +344,12 @@ make_toplevel (void)
   return surface;
 }
 
-static gboolean
-parse_node_file (GFile *file, const char *generate)
+static void
+skip_if_unsupported (GdkSurface *surface)
 {
-  char *reference_file;
-  GdkSurface *surface;
   GdkSubsurface *subsurface;
-  GskOffload *offload;
-  GskRenderNode *node, *tmp;
-  GBytes *offload_state;
-  GError *error = NULL;
-  gboolean result = TRUE;
-  cairo_region_t *clip, *region;
-  char *path, *diff;
-  GskRenderNode *node2;
-  const char *generate_values[] = { "offload", "offload2", "diff", NULL };
   int udmabuf_fd;
 
-  if (generate && !g_strv_contains (generate_values, generate))
-    {
-      g_print ("Allowed --generate values are: ");
-      for (int i = 0; generate_values[i]; i++)
-        g_print ("%s ", generate_values[i]);
-      g_print ("\n");
-      return FALSE;
-    }
-
-  surface = make_toplevel ();
-
   if (!GDK_DISPLAY_DEBUG_CHECK (gdk_display_get_default (), FORCE_OFFLOAD))
     {
       g_print ("Offload tests require GDK_DEBUG=force-offload\n");
@@ -399,6 +377,34 @@ parse_node_file (GFile *file, const char *generate)
       exit (77); /* subsurfaces aren't supported, skip these tests */
     }
   close (udmabuf_fd);
+}
+
+static gboolean
+parse_node_file (GFile *file, const char *generate)
+{
+  char *reference_file;
+  GdkSurface *surface;
+  GskOffload *offload;
+  GskRenderNode *node, *tmp;
+  GBytes *offload_state;
+  GError *error = NULL;
+  gboolean result = TRUE;
+  cairo_region_t *clip, *region;
+  char *path, *diff;
+  GskRenderNode *node2;
+  const char *generate_values[] = { "offload", "offload2", "diff", NULL };
+
+  if (generate && !g_strv_contains (generate_values, generate))
+    {
+      g_print ("Allowed --generate values are: ");
+      for (int i = 0; generate_values[i]; i++)
+        g_print ("%s ", generate_values[i]);
+      g_print ("\n");
+      return FALSE;
+    }
+
+  surface = make_toplevel ();
+  skip_if_unsupported (surface);
 
   node = node_from_file (file);
   if (node == NULL)
@@ -515,6 +521,84 @@ parse_node_file (GFile *file, const char *generate)
   return result;
 }
 
+static gboolean
+check_holdoff_frame (GdkSurface    *surface,
+                     GskRenderNode *node,
+                     gboolean       expected,
+                     int            frame)
+{
+  GskOffload *offload;
+  GskOffloadInfo *info;
+  cairo_region_t *diff;
+  gboolean result;
+
+  diff = cairo_region_create ();
+  offload = gsk_offload_new (surface, node, diff);
+  info = gsk_offload_get_subsurface_info (offload, gdk_surface_get_subsurface (surface, 0));
+
+  result = info->is_offloaded == expected;
+  if (!result)
+    g_print ("Frame %d: subsurface is %soffloaded, expected it %soffloaded\n",
+             frame,
+             info->is_offloaded ? "" : "not ",
+             expected ? "" : "not ");
+
+  gsk_offload_free (offload);
+  cairo_region_destroy (diff);
+
+  return result;
+}
+
+/* After a frame that can't offload a subsurface, we wait for
+ * OFFLOAD_HOLDOFF_FRAMES frames before offloading it again, and
+ * every failing frame restarts the wait.
+ */
+static gboolean
+test_holdoff (const char *dir)
+{
+  GdkSurface *surface;
+  GskRenderNode *offloadable, *not_offloadable, *tmp;
+  gboolean result = TRUE;
+  char *path;
+  int frame, i;
+
+  surface = make_toplevel ();
+  skip_if_unsupported (surface);
+
+  path = g_build_filename (dir, "stop_offloading.node", NULL);
+  tmp = node_from_path (path);
+  offloadable = gsk_render_node_attach (tmp, surface);
+  gsk_render_node_unref (tmp);
+  g_free (path);
+
+  path = g_build_filename (dir, "stop_offloading.node2", NULL);
+  tmp = node_from_path (path);
+  not_offloadable = gsk_render_node_attach (tmp, surface);
+  gsk_render_node_unref (tmp);
+  g_free (path);
+
+  frame = 0;
+  result &= check_holdoff_frame (surface, offloadable, TRUE, frame++);
+  result &= check_holdoff_frame (surface, not_offloadable, FALSE, frame++);
+
+  for (i = 0; i < OFFLOAD_HOLDOFF_FRAMES / 2; i++)
+    result &= check_holdoff_frame (surface, offloadable, FALSE, frame++);
+
+  /* fail again while waiting */
+  result &= check_holdoff_frame (surface, not_offloadable, FALSE, frame++);
+
+  for (i = 0; i < OFFLOAD_HOLDOFF_FRAMES; i++)
+    result &= check_holdoff_frame (surface, offloadable, FALSE, frame++);
+
+  result &= check_holdoff_frame (surface, offloadable, TRUE, frame++);
+
+  gsk_render_node_unref (offloadable);
+  gsk_render_node_unref (not_offloadable);
+  gdk_surface_destroy (surface);
+
+  return result;
+}
+
 static gboolean
 test_file (GFile *file)
 {
@@ -632,6 +716,15 @@ main (int argc, char **argv)
 
       g_object_unref (dir);
     }
+  else if (g_str_equal (argv[1], "--holdoff"))
+    {
+      gtk_test_init (&argc, &argv);
+
+      if (argc >= 3)
+        success = test_holdoff (argv[2]);
+      else
+        success = FALSE;
+    }
   else if (g_str_has_prefix (argv[1], "--generate="))
     {
       /* We have up to 3 different result files, the extra
@@ -0,0 +1,139 @@
+#include "config.h"
+
+#include <gtk/gtk.h>
+
+#include "testsuite/gdk/gdktestutils.h"
+
+/* Tests for GSK_GPU_ENABLE=retain, which keeps unchanged containers
+ * in offscreens. A container gets retained after being drawn in two
+ * frames, so we always render 3 times to hit the cache.
+ */
+
+struct {
+  const char *name;
+  GskRenderer * (*create_func) (void);
+  GskRenderer *renderer;
+} renderers[] = {
+  {
+    "vulkan",
+    gsk_vulkan_renderer_new,
+  },
+  {
+    "gl",
+    gsk_gl_renderer_new,
+  },
+};
+
+static GskRenderNode *
+create_container (const GdkRGBA *left,
+                  const GdkRGBA *right)
+{
+  GskRenderNode *children[2];
+  GskRenderNode *node;
+
+  children[0] = gsk_color_node_new (left, &GRAPHENE_RECT_INIT (0, 0, 150, 300));
+  children[1] = gsk_color_node_new (right, &GRAPHENE_RECT_INIT (150, 0, 150, 300));
+  node = gsk_container_node_new (children, G_N_ELEMENTS (children));
+
+  gsk_render_node_unref (children[0]);
+  gsk_render_node_unref (children[1]);
+
+  return node;
+}
+
+static void
+test_retain_unchanged (gconstpointer data)
+{
+  GskRenderer *renderer = renderers[GPOINTER_TO_SIZE (data)].renderer;
+  GskRenderNode *node;
+  GdkTexture *first, *texture;
+  int i;
+
+  node = create_container (&(GdkRGBA) { 1, 0, 0, 1 }, &(GdkRGBA) { 0, 0, 1, 1 });
+
+  first = gsk_renderer_render_texture (renderer, node, NULL);
+  for (i = 0; i < 2; i++)
+    {
+      texture = gsk_renderer_render_texture (renderer, node, NULL);
+      compare_textures (first, texture, TRUE);
+      g_object_unref (texture);
+    }
+
+  g_object_unref (first);
+  gsk_render_node_unref (node);
+}
+
+static void
+add_renderer_test (const char    *name,
+                   GTestDataFunc  func)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      char *test_name;
+
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      test_name = g_strdup_printf ("%s/%s", name, renderers[i].name);
+      g_test_add_data_func (test_name, GSIZE_TO_POINTER (i), func);
+      g_free (test_name);
+    }
+}
+
+static void
+create_renderers (void)
+{
+  GError *error = NULL;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      renderers[i].renderer = renderers[i].create_func ();
+      if (!gsk_renderer_realize_for_display (renderers[i].renderer, gdk_display_get_default (), &error))
+        {
+          g_test_message ("Could not realize %s renderer: %s", renderers[i].name, error->message);
+          g_clear_error (&error);
+          g_clear_object (&renderers[i].renderer);
+        }
+    }
+}
+
+static void
+destroy_renderers (void)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (renderers); i++)
+    {
+      if (renderers[i].renderer == NULL)
+        continue;
+
+      gsk_renderer_unrealize (renderers[i].renderer);
+      g_clear_object (&renderers[i].renderer);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int result;
+
+  /* must be set before the renderer classes are initialized */
+  g_setenv ("GSK_GPU_ENABLE", "retain", TRUE);
+
+  gtk_test_init (&argc, &argv, NULL);
+  create_renderers ();
+
+  add_renderer_test ("/retain/unchanged", test_retain_unchanged);
+
+  result = g_test_run ();
+
+  /* So the context gets actually destroyed */
+  gdk_gl_context_clear_current ();
+
+  destroy_renderers ();
+
+  return result;
+}
@@ -0,0 +1,214 @@
+#include <gtk/gtk.h>
+#include "../../gtk/gtkconstraintlayoutprivate.h"
+#include "../../gtk/gtkconstraintsolverprivate.h"
+
+#define GTK_TYPE_GIZMO                 (gtk_gizmo_get_type ())
+#define GTK_GIZMO(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_GIZMO, GtkGizmo))
+
+typedef struct _GtkGizmo GtkGizmo;
+
+struct _GtkGizmo {
+  GtkWidget parent;
+
+  int min_size;
+  int nat_size;
+  int width;
+  int height;
+};
+
+typedef GtkWidgetClass GtkGizmoClass;
+
+G_DEFINE_TYPE (GtkGizmo, gtk_gizmo, GTK_TYPE_WIDGET);
+
+static void
+gtk_gizmo_measure (GtkWidget      *widget,
+                   GtkOrientation  orientation,
+                   int             for_size,
+                   int            *minimum,
+                   int            *natural,
+                   int            *minimum_baseline,
+                   int            *natural_baseline)
+{
+  GtkGizmo *self = GTK_GIZMO (widget);
+
+  *minimum = self->min_size;
+  *natural = self->nat_size;
+}
+
+static void
+gtk_gizmo_size_allocate (GtkWidget *widget,
+                         int        width,
+                         int        height,
+                         int        baseline)
+{
+  GtkGizmo *self = GTK_GIZMO (widget);
+
+  self->width = width;
+  self->height = height;
+}
+
+static void
+gtk_gizmo_class_init (GtkGizmoClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  widget_class->measure = gtk_gizmo_measure;
+  widget_class->size_allocate = gtk_gizmo_size_allocate;
+}
+
+static void
+gtk_gizmo_init (GtkGizmo *self)
+{
+}
+
+/* A parent with a constraint layout, and a child that
+ * fills it, minus a margin of 10 on each side
+ */
+static GtkConstraintLayout *
+add_layout (GtkWidget  *box,
+            GtkGizmo  **child)
+{
+  GtkLayoutManager *layout;
+  GtkWidget *parent;
+  GtkConstraintAttribute attrs[] = {
+    GTK_CONSTRAINT_ATTRIBUTE_LEFT,
+    GTK_CONSTRAINT_ATTRIBUTE_TOP,
+    GTK_CONSTRAINT_ATTRIBUTE_RIGHT,
+    GTK_CONSTRAINT_ATTRIBUTE_BOTTOM,
+  };
+  double offsets[] = { 10, 10, -10, -10 };
+  int i;
+
+  parent = g_object_new (GTK_TYPE_GIZMO, NULL);
+  gtk_box_append (GTK_BOX (box), parent);
+
+  layout = gtk_constraint_layout_new ();
+  gtk_widget_set_layout_manager (parent, layout);
+
+  *child = g_object_new (GTK_TYPE_GIZMO, NULL);
+  (*child)->min_size = 10;
+  (*child)->nat_size = 20;
+  gtk_widget_set_parent (GTK_WIDGET (*child), parent);
+
+  for (i = 0; i < G_N_ELEMENTS (attrs); i++)
+    gtk_constraint_layout_add_constraint (GTK_CONSTRAINT_LAYOUT (layout),
+                                          gtk_constraint_new (*child, attrs[i],
+                                                              GTK_CONSTRAINT_RELATION_EQ,
+                                                              NULL, attrs[i],
+                                                              1.0, offsets[i],
+                                                              GTK_CONSTRAINT_STRENGTH_REQUIRED));
+
+  return GTK_CONSTRAINT_LAYOUT (layout);
+}
+
+/* Measures and allocates the layout, and returns whether that
+ * touched the solver. Measuring always uses the solver, so we
+ * only look at the allocation.
+ */
+static gboolean
+allocate_layout (GtkConstraintLayout *layout,
+                 int                  width,
+                 int                  height)
+{
+  GtkLayoutManager *manager = GTK_LAYOUT_MANAGER (layout);
+  GtkWidget *widget = gtk_layout_manager_get_widget (manager);
+  GtkConstraintSolver *solver;
+  char *before, *after;
+  gboolean solved;
+
+  gtk_layout_manager_measure (manager, widget, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+  gtk_layout_manager_measure (manager, widget, GTK_ORIENTATION_VERTICAL, -1, NULL, NULL, NULL, NULL);
+
+  solver = gtk_constraint_layout_get_solver (layout);
+  before = gtk_constraint_solver_statistics (solver);
+
+  gtk_layout_manager_allocate (manager, widget, width, height, -1);
+
+  after = gtk_constraint_solver_statistics (solver);
+  solved = !g_str_equal (before, after);
+
+  g_free (before);
+  g_free (after);
+
+  return solved;
+}
+
+static void
+test_reuse_allocation (void)
+{
+  GtkWidget *window, *box;
+  GtkConstraintLayout *layout1, *layout2;
+  GtkGizmo *child1, *child2;
+
+  g_test_summary ("Allocations are reused as long as the inputs of a layout don't change, "
+                  "even if other layouts in the same root change the shared solver");
+
+  window = gtk_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_window_set_child (GTK_WINDOW (window), box);
+
+  layout1 = add_layout (box, &child1);
+  layout2 = add_layout (box, &child2);
+
+  g_assert_true (allocate_layout (layout1, 100, 100));
+  g_assert_cmpint (child1->width, ==, 80);
+  g_assert_cmpint (child1->height, ==, 80);
+  g_assert_true (allocate_layout (layout2, 100, 100));
+
+  /* Nothing changed */
+  g_assert_false (allocate_layout (layout1, 100, 100));
+  g_assert_cmpint (child1->width, ==, 80);
+  g_assert_cmpint (child1->height, ==, 80);
+
+  /* Change the solver through the other layout */
+  gtk_constraint_layout_add_constraint (layout2,
+                                        gtk_constraint_new_constant (child2,
+                                                                     GTK_CONSTRAINT_ATTRIBUTE_WIDTH,
+                                                                     GTK_CONSTRAINT_RELATION_GE,
+                                                                     50,
+                                                                     GTK_CONSTRAINT_STRENGTH_REQUIRED));
+  g_assert_true (allocate_layout (layout2, 100, 100));
+
+  g_assert_false (allocate_layout (layout1, 100, 100));
+  g_assert_cmpint (child1->width, ==, 80);
+  g_assert_cmpint (child1->height, ==, 80);
+
+  /* A new size needs a new solve */
+  g_assert_true (allocate_layout (layout1, 120, 100));
+  g_assert_cmpint (child1->width, ==, 100);
+  g_assert_cmpint (child1->height, ==, 80);
+
+  /* So do new child sizes */
+  child1->min_size = 15;
+  gtk_widget_queue_resize (GTK_WIDGET (child1));
+  g_assert_true (allocate_layout (layout1, 120, 100));
+  g_assert_cmpint (child1->width, ==, 100);
+  g_assert_cmpint (child1->height, ==, 80);
+
+  /* And new constraints */
+  gtk_constraint_layout_add_constraint (layout1,
+                                        gtk_constraint_new_constant (child1,
+                                                                     GTK_CONSTRAINT_ATTRIBUTE_HEIGHT,
+                                                                     GTK_CONSTRAINT_RELATION_GE,
+                                                                     50,
+                                                                     GTK_CONSTRAINT_STRENGTH_REQUIRED));
+  g_assert_true (allocate_layout (layout1, 120, 100));
+  g_assert_cmpint (child1->width, ==, 100);
+  g_assert_cmpint (child1->height, ==, 80);
+
+  gtk_widget_unparent (GTK_WIDGET (child1));
+  gtk_widget_unparent (GTK_WIDGET (child2));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/constraint-layout/reuse-allocation", test_reuse_allocation);
+
+  return g_test_run ();
+}
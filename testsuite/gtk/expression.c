@@ -64,6 +64,64 @@ test_property (void)
   g_object_unref (filter);
 }
 
+typedef struct {
+  GtkExpressionWatch *other;
+  guint counter;
+} UnwatchData;
+
+static void
+unwatch_other (gpointer data)
+{
+  UnwatchData *unwatch = data;
+
+  unwatch->counter += 1;
+
+  if (unwatch->other)
+    {
+      gtk_expression_watch_unwatch (unwatch->other);
+      unwatch->other = NULL;
+    }
+}
+
+static void
+test_shared_property_watches (void)
+{
+  GtkExpression *expr;
+  GtkExpressionWatch *watch1, *watch2;
+  GtkStringFilter *filter;
+  UnwatchData data1 = { NULL, 0 };
+  UnwatchData data2 = { NULL, 0 };
+  guint counter = 0;
+
+  filter = gtk_string_filter_new (NULL);
+  expr = gtk_property_expression_new (GTK_TYPE_STRING_FILTER, NULL, "search");
+
+  watch1 = gtk_expression_watch (expr, filter, unwatch_other, &data1, NULL);
+  watch2 = gtk_expression_watch (expr, filter, unwatch_other, &data2, NULL);
+  gtk_expression_watch (expr, filter, inc_counter, &counter, NULL);
+
+  gtk_string_filter_set_search (filter, "Hello");
+  g_assert_cmpint (data1.counter, ==, 1);
+  g_assert_cmpint (data2.counter, ==, 1);
+  g_assert_cmpint (counter, ==, 1);
+
+  /* Whichever watch is notified first removes the other one */
+  gtk_expression_watch_ref (watch1);
+  gtk_expression_watch_ref (watch2);
+  data1.other = watch2;
+  data2.other = watch1;
+  gtk_string_filter_set_search (filter, "World");
+  g_assert_cmpint (data1.counter + data2.counter, ==, 3);
+  g_assert_cmpint (counter, ==, 2);
+  gtk_expression_watch_unref (watch1);
+  gtk_expression_watch_unref (watch2);
+
+  /* Watches going away with the object drop the shared handler */
+  g_object_unref (filter);
+
+  gtk_expression_unref (expr);
+}
+
 static void
 test_interface_property (void)
 {
@@ -804,6 +862,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/expression/binds", test_binds);
   g_test_add_func ("/expression/bind-object", test_bind_object);
   g_test_add_func ("/expression/value", test_value);
+  g_test_add_func ("/expression/shared-property-watches", test_shared_property_watches);
 
   return g_test_run ();
 }
@@ -48,12 +48,89 @@ test_measure_crash (void)
   gtk_window_destroy (GTK_WINDOW (window));
 }
 
+static GtkWidget *
+create_label (gpointer item,
+              gpointer data)
+{
+  return gtk_label_new (gtk_string_object_get_string (item));
+}
+
+static void
+on_selected_children_changed (GtkFlowBox *box,
+                              gpointer    data)
+{
+  int *i = data;
+
+  (*i)++;
+}
+
+/* Removing a range of selected children from the model
+ * only emits selected-children-changed once
+ */
+static void
+test_bound_model_remove_selected (void)
+{
+  GtkFlowBox *box;
+  GListStore *store;
+  GtkStringObject *item;
+  GList *l;
+  int i;
+  char *s;
+  int count;
+
+  store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  for (i = 0; i < 100; i++)
+    {
+      s = g_strdup_printf ("%d", i);
+      item = gtk_string_object_new (s);
+      g_list_store_append (store, item);
+      g_object_unref (item);
+      g_free (s);
+    }
+
+  box = GTK_FLOW_BOX (gtk_flow_box_new ());
+  g_object_ref_sink (box);
+  gtk_flow_box_set_selection_mode (box, GTK_SELECTION_MULTIPLE);
+  gtk_flow_box_bind_model (box, G_LIST_MODEL (store), create_label, NULL, NULL);
+
+  for (i = 10; i < 20; i++)
+    gtk_flow_box_select_child (box, gtk_flow_box_get_child_at_index (box, i));
+
+  count = 0;
+  g_signal_connect (box, "selected-children-changed",
+                    G_CALLBACK (on_selected_children_changed),
+                    &count);
+
+  /* No selected children in the range */
+  g_list_store_splice (store, 50, 10, NULL, 0);
+  g_assert_cmpint (count, ==, 0);
+
+  g_list_store_splice (store, 5, 20, NULL, 0);
+  g_assert_cmpint (count, ==, 1);
+  g_assert_null (gtk_flow_box_get_selected_children (box));
+
+  /* Only part of the selection is removed */
+  for (i = 10; i < 20; i++)
+    gtk_flow_box_select_child (box, gtk_flow_box_get_child_at_index (box, i));
+
+  count = 0;
+  g_list_store_splice (store, 15, 10, NULL, 0);
+  g_assert_cmpint (count, ==, 1);
+  l = gtk_flow_box_get_selected_children (box);
+  g_assert_cmpint (g_list_length (l), ==, 5);
+  g_list_free (l);
+
+  g_object_unref (box);
+  g_object_unref (store);
+}
+
 int
 main (int argc, char *argv[])
 {
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/flowbox/measure-crash", test_measure_crash);
+  g_test_add_func ("/flowbox/bound-model/remove-selected", test_bound_model_remove_selected);
 
   return g_test_run ();
 }
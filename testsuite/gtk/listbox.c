@@ -437,6 +437,91 @@ test_header (void)
   g_object_unref (list);
 }
 
+static GtkWidget *
+create_label (gpointer item,
+              gpointer data)
+{
+  return gtk_label_new (gtk_string_object_get_string (item));
+}
+
+static void
+on_row_selected (GtkListBox    *box,
+                 GtkListBoxRow *row,
+                 gpointer       data)
+{
+  int *i = data;
+
+  (*i)++;
+}
+
+/* Removing a range of selected rows from the model
+ * only emits the selection signals once
+ */
+static void
+test_bound_model_remove_selected (void)
+{
+  GtkListBox *list;
+  GListStore *store;
+  GtkStringObject *item;
+  GList *l;
+  int i;
+  char *s;
+  int changed_count, selected_count;
+
+  store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  for (i = 0; i < 100; i++)
+    {
+      s = g_strdup_printf ("%d", i);
+      item = gtk_string_object_new (s);
+      g_list_store_append (store, item);
+      g_object_unref (item);
+      g_free (s);
+    }
+
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  g_object_ref_sink (list);
+  gtk_list_box_set_selection_mode (list, GTK_SELECTION_MULTIPLE);
+  gtk_list_box_bind_model (list, G_LIST_MODEL (store), create_label, NULL, NULL);
+
+  for (i = 10; i < 20; i++)
+    gtk_list_box_select_row (list, gtk_list_box_get_row_at_index (list, i));
+
+  changed_count = 0;
+  g_signal_connect (list, "selected-rows-changed",
+                    G_CALLBACK (on_selected_rows_changed),
+                    &changed_count);
+  selected_count = 0;
+  g_signal_connect (list, "row-selected",
+                    G_CALLBACK (on_row_selected),
+                    &selected_count);
+
+  /* No selected rows in the range */
+  g_list_store_splice (store, 50, 10, NULL, 0);
+  g_assert_cmpint (changed_count, ==, 0);
+  g_assert_cmpint (selected_count, ==, 0);
+
+  g_list_store_splice (store, 5, 20, NULL, 0);
+  g_assert_cmpint (changed_count, ==, 1);
+  g_assert_cmpint (selected_count, ==, 1);
+  g_assert_null (gtk_list_box_get_selected_rows (list));
+
+  /* Only part of the selection is removed */
+  for (i = 10; i < 20; i++)
+    gtk_list_box_select_row (list, gtk_list_box_get_row_at_index (list, i));
+
+  changed_count = 0;
+  selected_count = 0;
+  g_list_store_splice (store, 15, 10, NULL, 0);
+  g_assert_cmpint (changed_count, ==, 1);
+  g_assert_cmpint (selected_count, ==, 1);
+  l = gtk_list_box_get_selected_rows (list);
+  g_assert_cmpint (g_list_length (l), ==, 5);
+  g_list_free (l);
+
+  g_object_unref (list);
+  g_object_unref (store);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -447,6 +532,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/listbox/multi-selection", test_multi_selection);
   g_test_add_func ("/listbox/filter", test_filter);
   g_test_add_func ("/listbox/header", test_header);
+  g_test_add_func ("/listbox/bound-model/remove-selected", test_bound_model_remove_selected);
 
   return g_test_run ();
 }
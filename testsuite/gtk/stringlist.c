@@ -281,6 +281,34 @@ test_find (void)
   g_object_unref (list);
 }
 
+static void
+test_get_item (void)
+{
+  GtkStringList *list;
+  GtkStringObject *obj1, *obj2;
+
+  list = new_model ((const char *[]){ "a", "b", "c", NULL });
+
+  /* Items keep their identity once they have been created */
+  obj1 = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  obj2 = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_true (obj1 == obj2);
+  g_assert_cmpstr (gtk_string_object_get_string (obj1), ==, "b");
+  g_assert_cmpstr (gtk_string_list_get_string (list, 1), ==, "b");
+  g_assert_true (gtk_string_list_get_string (list, 1) == gtk_string_object_get_string (obj1));
+  g_assert_cmpuint (gtk_string_list_find (list, "b"), ==, 1);
+  g_object_unref (obj2);
+
+  /* Removing the string keeps the object alive for its users */
+  gtk_string_list_remove (list, 1);
+  assert_model (list, "a c");
+  assert_changes (list, "-1");
+  g_assert_cmpstr (gtk_string_object_get_string (obj1), ==, "b");
+  g_object_unref (obj1);
+
+  g_object_unref (list);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -298,6 +326,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
   g_test_add_func ("/stringlist/find", test_find);
+  g_test_add_func ("/stringlist/get_item", test_get_item);
 
   return g_test_run ();
 }
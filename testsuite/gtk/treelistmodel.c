@@ -339,6 +339,27 @@ test_expand (void)
   g_object_unref (tree);
 }
 
+static void
+test_expand_to_depth (void)
+{
+  GtkTreeListModel *tree = new_model (100, FALSE);
+  GtkTreeListRow *row;
+
+  assert_model (tree, "100");
+
+  row = gtk_tree_list_model_get_row (tree, 0);
+  gtk_tree_list_row_expand_to_depth (row, 2);
+  g_assert_true (gtk_tree_list_row_get_expanded (row));
+  assert_model (tree, "100 100 100 99 98 97 96 95 94 93 92 91 90 90 89 88 87 86 85 84 83 82 81 80 80 79 78 77 76 75 74 73 72 71 70 70 69 68 67 66 65 64 63 62 61 60 60 59 58 57 56 55 54 53 52 51 50 50 49 48 47 46 45 44 43 42 41 40 40 39 38 37 36 35 34 33 32 31 30 30 29 28 27 26 25 24 23 22 21 20 20 19 18 17 16 15 14 13 12 11 10 10 9 8 7 6 5 4 3 2 1");
+  assert_changes (tree, "1+110*");
+
+  gtk_tree_list_row_expand_to_depth (row, G_MAXUINT);
+  assert_changes (tree, "");
+
+  g_object_unref (row);
+  g_object_unref (tree);
+}
+
 static void
 test_remove_some (void)
 {
@@ -623,6 +644,7 @@ main (int argc, char *argv[])
   changes_quark = g_quark_from_static_string ("What did I see? Can I believe what I saw?");
 
   g_test_add_func ("/treelistmodel/expand", test_expand);
+  g_test_add_func ("/treelistmodel/expand-to-depth", test_expand_to_depth);
   g_test_add_func ("/treelistmodel/remove_some", test_remove_some);
   g_test_add_func ("/treelistmodel/remove_splice", test_splice);
   g_test_add_func ("/treelistmodel/collapse-change", test_collapse_change);